@@ -245,11 +245,17 @@ std::vector<SearchResult> DjvuBridge::SearchForTextPreviews(int page, std::wstri
 
 void DjvuBridge::processTextSearchPreviews(CmdRequest &request, CmdResponse &response)
 {
-    response.cmd = CMD_RES_SEARCH_PREVIEWS;
+    bool stream = request.cmd == CMD_REQ_SEARCH_STREAM;
+    response.cmd = stream ? CMD_RES_SEARCH_STREAM : CMD_RES_SEARCH_PREVIEWS;
 
     CmdDataIterator iter(request.first);
     uint8_t *temp_val;
+    uint32_t batch = 0;
     iter.getByteArray(&temp_val);
+    if (stream)
+    {
+        iter.getInt(&batch);
+    }
     if (!iter.isValid())
     {
         LE("processTextSearchPreviews bad request data");
@@ -296,6 +302,11 @@ void DjvuBridge::processTextSearchPreviews(CmdRequest &request, CmdResponse &res
     query = lowercase(query);
     for (int p = pagestart; p <= pageend; p++)
     {
+        if (isCancelled())
+        {
+            response.result = RES_CANCELLED;
+            return;
+        }
         std::vector<SearchResult> pagestrings;
         pagestrings = SearchForTextPreviews(p, query);
 
@@ -321,8 +332,16 @@ void DjvuBridge::processTextSearchPreviews(CmdRequest &request, CmdResponse &res
 
             //LE("processTextSearchPreviews found [%d]^[%d] = [%s][%s]",p,curr.xpointers_.size(),wstringToString(text).c_str(),xpointers_str.c_str());
         }
+        uint32_t scanned = p - pagestart + 1;
+        if (stream && batch > 0 && scanned % batch == 0 && p < pageend)
+        {
+            sendSearchBatch(request, response, scanned, pageend - pagestart + 1, searchPackCounter);
+        }
+    }
+    if (stream)
+    {
+        finishSearchStream(response, pageend - pagestart + 1, pageend - pagestart + 1, searchPackCounter);
     }
-
 }
 
 void DjvuBridge::processTextSearchHitboxes(CmdRequest &request, CmdResponse &response)
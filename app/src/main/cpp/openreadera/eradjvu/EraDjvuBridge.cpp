@@ -16,6 +16,7 @@
  */
 
 #include <stdlib.h>
+#include <algorithm>
 
 #include "ore_log.h"
 #include "StProtocol.h"
@@ -27,6 +28,8 @@
 #include "openreadera_version.h"
 
 #define RES_DJVU_FAIL       255
+// Page is rendered by bands of this height, so render can be cancelled between them
+#define RENDER_BAND_HEIGHT  512
 
 DjvuBridge::DjvuBridge() : StBridge("EraDjvuBridge")
 {
@@ -111,6 +114,21 @@ void DjvuBridge::process(CmdRequest &request, CmdResponse &response)
         case CMD_REQ_PAGE_FREE:
             processPageFree(request, response);
             break;
+        case CMD_REQ_DJVU_CACHE:
+            processCache(request, response);
+            break;
+        case CMD_REQ_RENDER_BUFFER:
+            processRenderBuffer(request, response);
+            break;
+        case CMD_REQ_PAGE_TILE:
+            processPageTile(request, response);
+            break;
+        case CMD_REQ_TILE_CACHE:
+            processTileCache(request, response);
+            break;
+        case CMD_REQ_PREFETCH:
+            processPrefetch(request, response);
+            break;
         case CMD_REQ_SMART_CROP:
             processSmartCrop(request, response);
             break;
@@ -130,6 +148,7 @@ void DjvuBridge::process(CmdRequest &request, CmdResponse &response)
             processXPathByRectId(request, response);
             break;
         case CMD_REQ_SEARCH_PREVIEWS:
+        case CMD_REQ_SEARCH_STREAM:
             processTextSearchPreviews(request, response);
             break;
         case CMD_REQ_SEARCH_HITBOXES:
@@ -209,10 +228,11 @@ void DjvuBridge::processOpen(CmdRequest& request, CmdResponse& response)
     if (doc == NULL)
     {
         context = ddjvu_context_create("EraDjvuBridge");
+        ddjvu_cache_set_size(context, cacheSize);
         char url[1024];
         sprintf(url, "fd:%d", fd);
         LD("Opening url: %s", url);
-        doc = ddjvu_document_create_by_filename(context, url, FALSE);
+        doc = ddjvu_document_create_by_filename(context, url, TRUE);
         if (!doc)
         {
             LE("DJVU file not found or corrupted.");
@@ -315,7 +335,7 @@ void DjvuBridge::processPage(CmdRequest& request, CmdResponse& response)
     }
 
     ddjvu_pageinfo_t* i = getPageInfo(pageNumber);
-    ddjvu_page_t* p = getPage(pageNumber, false);
+    ddjvu_page_t* p = getRequestedPage(pageNumber, false);
 
     if (i == NULL || p == NULL)
     {
@@ -362,6 +382,39 @@ void DjvuBridge::processPageFree(CmdRequest& request, CmdResponse& response)
     }
 }
 
+void DjvuBridge::processCache(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_DJVU_CACHE;
+    if (request.dataCount > 0)
+    {
+        uint32_t size = 0;
+        if (!CmdDataIterator(request.first).getInt(&size).isValid())
+        {
+            LE("Bad request data");
+            response.result = RES_BAD_REQ_DATA;
+            return;
+        }
+        if (size > 0)
+        {
+            cacheSize = size;
+        }
+        if (context != NULL)
+        {
+            if (size == 0)
+            {
+                // ddjvu_cache_clear also closes data pools of opened document, so cache is shrunk instead
+                ddjvu_cache_set_size(context, 1);
+            }
+            ddjvu_cache_set_size(context, cacheSize);
+        }
+        LI("DjVu cache size: %u", cacheSize);
+    }
+    response.addInt(cacheHits);
+    response.addInt(cacheMisses);
+    response.addInt(context != NULL ? (uint32_t) ddjvu_cache_get_used(context) : 0);
+    response.addInt(cacheSize);
+}
+
 void DjvuBridge::processPageRender(CmdRequest& request, CmdResponse& response)
 {
     response.cmd = CMD_RES_PAGE_RENDER;
@@ -399,7 +452,7 @@ void DjvuBridge::processPageRender(CmdRequest& request, CmdResponse& response)
     float pageSliceWidth = temp_config[2];
     float pageSliceHeight = temp_config[3];
 
-    ddjvu_page_t* p = getPage(pageNumber, true);
+    ddjvu_page_t* p = getRequestedPage(pageNumber, true);
 
     ddjvu_rect_t pageRect;
     pageRect.x = 0;
@@ -420,18 +473,36 @@ void DjvuBridge::processPageRender(CmdRequest& request, CmdResponse& response)
 
     int size = targetRect.w * targetRect.h * 4;
     CmdData* resp = new CmdData();
-    char* pixels = (char*)resp->newByteArray(size);
+    char* pixels = (char*) newRenderPixels(resp, size);
 
-    int result = ddjvu_page_render(
-            pages[pageNumber],
-            (ddjvu_render_mode_t) HARDCONFIG_DJVU_RENDERING_MODE,
-            &pageRect,
-            &targetRect,
-        pixelFormat, targetWidth * 4, pixels);
+    int result = 1;
+    bool cancelled = false;
+    ddjvu_rect_t bandRect = targetRect;
+    for (unsigned int y = 0; result && y < targetRect.h; y += RENDER_BAND_HEIGHT)
+    {
+        if (isCancelled())
+        {
+            cancelled = true;
+            break;
+        }
+        bandRect.y = targetRect.y + y;
+        bandRect.h = std::min((unsigned int) RENDER_BAND_HEIGHT, targetRect.h - y);
+        result = ddjvu_page_render(
+                pages[pageNumber],
+                (ddjvu_render_mode_t) HARDCONFIG_DJVU_RENDERING_MODE,
+                &pageRect,
+                &bandRect,
+                pixelFormat, targetWidth * 4, pixels + y * targetWidth * 4);
+    }
 
     ddjvu_format_release(pixelFormat);
 
-    if (!result)
+    if (cancelled)
+    {
+        response.result = RES_CANCELLED;
+        delete resp;
+    }
+    else if (!result)
     {
         response.result = RES_DJVU_FAIL;
         delete resp;
@@ -439,7 +510,124 @@ void DjvuBridge::processPageRender(CmdRequest& request, CmdResponse& response)
     else
     {
         response.addData(resp);
+        schedulePrefetch(pageNumber, pageCount);
+    }
+}
+
+void DjvuBridge::processPageTile(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_PAGE_TILE;
+    StTileKey key;
+    key.config = 0;
+    CmdDataIterator iter(request.first);
+    iter.getInt(&key.page)
+            .getFloat(&key.zoom)
+            .getInt(&key.x)
+            .getInt(&key.y)
+            .getInt(&key.size);
+
+    if (!iter.isValid() || key.size == 0 || key.size > TILE_MAX_SIZE || key.zoom <= 0)
+    {
+        LE("Bad request data");
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    if (doc == NULL || pages == NULL)
+    {
+        LE("Document not yet opened");
+        response.result = RES_ILLEGAL_STATE;
+        return;
+    }
+    if (key.page >= pageCount)
+    {
+        LE("Invalid page number: %d from %d", key.page, pageCount);
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    schedulePrefetch(key.page, pageCount);
+
+    uint32_t size = key.size * key.size * 4;
+    CmdData* resp = new CmdData();
+    char* pixels = (char*) newRenderPixels(resp, size);
+    const uint8_t* cached = tileCache.get(key);
+    if (cached != NULL)
+    {
+        memcpy(pixels, cached, size);
+        response.addData(resp);
+        return;
+    }
+
+    ddjvu_pageinfo_t* i = getPageInfo(key.page);
+    if (i == NULL)
+    {
+        response.result = RES_DJVU_FAIL;
+        delete resp;
+        return;
+    }
+    ddjvu_rect_t pageRect;
+    pageRect.x = 0;
+    pageRect.y = 0;
+    pageRect.w = i->width * key.zoom;
+    pageRect.h = i->height * key.zoom;
+
+    // Tiles on the right and bottom page edges are partially filled with white
+    memset(pixels, 0xFF, size);
+    uint64_t tileX = (uint64_t) key.x * key.size;
+    uint64_t tileY = (uint64_t) key.y * key.size;
+    if (tileX >= pageRect.w || tileY >= pageRect.h)
+    {
+        response.addData(resp);
+        return;
+    }
+    ddjvu_rect_t tileRect;
+    tileRect.x = (int) tileX;
+    tileRect.y = (int) tileY;
+    tileRect.w = std::min(key.size, pageRect.w - tileRect.x);
+    tileRect.h = std::min(key.size, pageRect.h - tileRect.y);
+
+    unsigned int masks[] = { 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 };
+    ddjvu_format_t* pixelFormat = ddjvu_format_create(DDJVU_FORMAT_RGBMASK32, 4, masks);
+    ddjvu_format_set_row_order(pixelFormat, TRUE);
+    ddjvu_format_set_y_direction(pixelFormat, TRUE);
+
+    int result = 0;
+    ddjvu_page_t* p = getRequestedPage(key.page, true);
+    if (p == NULL)
+    {
+        ddjvu_format_release(pixelFormat);
+        response.result = RES_DJVU_FAIL;
+        delete resp;
+        return;
+    }
+    if (!isCancelled())
+    {
+        result = ddjvu_page_render(
+                p,
+                (ddjvu_render_mode_t) HARDCONFIG_DJVU_RENDERING_MODE,
+                &pageRect,
+                &tileRect,
+                pixelFormat, key.size * 4, pixels);
+    }
+    ddjvu_format_release(pixelFormat);
+
+    if (isCancelled())
+    {
+        response.result = RES_CANCELLED;
+        delete resp;
+        return;
+    }
+    if (!result)
+    {
+        response.result = RES_DJVU_FAIL;
+        delete resp;
+        return;
+    }
+    uint8_t* tile = tileCache.put(key, size);
+    if (tile != NULL)
+    {
+        memcpy(tile, pixels, size);
     }
+    response.addData(resp);
 }
 
 void DjvuBridge::processOutline(CmdRequest& request, CmdResponse& response)
@@ -534,6 +722,66 @@ ddjvu_page_t* DjvuBridge::getPage(uint32_t pageNo, bool decode)
     return pages[pageNo];
 }
 
+ddjvu_page_t* DjvuBridge::getRequestedPage(uint32_t pageNo, bool decode)
+{
+    if (pages[pageNo] == NULL)
+    {
+        // Page of cached file is decoded at once
+        ddjvu_page_t* p = getPage(pageNo, false);
+        if (p != NULL && ddjvu_page_decoding_status(p) == DDJVU_JOB_OK)
+        {
+            cacheHits++;
+        }
+        else
+        {
+            cacheMisses++;
+        }
+    }
+    return getPage(pageNo, decode);
+}
+
+bool DjvuBridge::prefetchPage(uint32_t pageNo)
+{
+    if (doc == NULL || pages == NULL || pageNo >= pageCount)
+    {
+        return false;
+    }
+    bool loaded = pages[pageNo] == NULL;
+    ddjvu_page_t* p = getPage(pageNo, false);
+    if (p == NULL)
+    {
+        return false;
+    }
+    // Decoder posts messages at least once per chunk, so queued request waits for one chunk at most
+    ddjvu_status_t r;
+    while ((r = ddjvu_page_decoding_status(p)) < DDJVU_JOB_OK && !isCancelled())
+    {
+        waitAndHandleMessages();
+    }
+    if (r < DDJVU_JOB_OK)
+    {
+        // Page held by client keeps decoding, own page is dropped half-decoded
+        if (loaded)
+        {
+            ddjvu_job_stop(ddjvu_page_job(p));
+            ddjvu_page_release(p);
+            pages[pageNo] = NULL;
+        }
+        return false;
+    }
+    return loaded;
+}
+
+void DjvuBridge::releasePrefetchedPage(uint32_t pageNo)
+{
+    // Decoded file stays in ddjvuapi cache, so page comes back cheap if wanted later
+    if (pages != NULL && pageNo < pageCount && pages[pageNo] != NULL)
+    {
+        ddjvu_page_release(pages[pageNo]);
+        pages[pageNo] = NULL;
+    }
+}
+
 void DjvuBridge::waitAndHandleMessages()
 {
 // Wait for first message
@@ -628,7 +876,7 @@ void DjvuBridge::processSmartCrop(CmdRequest& request, CmdResponse& response)
     float slice_w = slice_r - slice_l;
     float slice_h = slice_b - slice_t;
 
-    ddjvu_page_t* p = getPage(page_index, true);
+    ddjvu_page_t* p = getRequestedPage(page_index, true);
 
     ddjvu_rect_t pageRect;
     pageRect.x = 0;
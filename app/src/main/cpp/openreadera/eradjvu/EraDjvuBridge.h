@@ -32,6 +32,9 @@
 #include "StSearchUtils.h"
 #include "openreadera.h"
 
+// Decoded DjVuFile objects are kept in ddjvuapi cache, so freed pages are not decoded again
+#define DJVU_FILE_CACHE_DEFAULT_SIZE (32 * 1024 * 1024)
+
 std::wstring djvu_stringToWstring(const std::string& t_str);
 
 std::string  djvu_wstringToString(const std::wstring& t_str);
@@ -166,6 +169,9 @@ private:
 
     DjvuOutline* outline;
     int searchPackCounter = 0;
+    uint32_t cacheSize = DJVU_FILE_CACHE_DEFAULT_SIZE;
+    uint32_t cacheHits = 0;
+    uint32_t cacheMisses = 0;
 
 public:
     DjvuBridge();
@@ -181,8 +187,10 @@ protected:
     void processPage(CmdRequest& request, CmdResponse& response);
     void processPageLinks(CmdRequest& request, CmdResponse& response);
     void processPageRender(CmdRequest& request, CmdResponse& response);
+    void processPageTile(CmdRequest& request, CmdResponse& response);
     void processSmartCrop(CmdRequest& request, CmdResponse& response);
     void processPageFree(CmdRequest& request, CmdResponse& response);
+    void processCache(CmdRequest& request, CmdResponse& response);
     void processOutline(CmdRequest& request, CmdResponse& response);
     void processPageText(CmdRequest& request, CmdResponse& response);
     void processXPathByRectId(CmdRequest &request, CmdResponse &response);
@@ -192,6 +200,10 @@ protected:
 
     ddjvu_pageinfo_t* getPageInfo(uint32_t pageNo);
     ddjvu_page_t* getPage(uint32_t pageNo, bool decode);
+    /// getPage() for client requests, counts decoded files cache hits and misses, prefetch is not counted
+    ddjvu_page_t* getRequestedPage(uint32_t pageNo, bool decode);
+    bool prefetchPage(uint32_t pageNo) override;
+    void releasePrefetchedPage(uint32_t pageNo) override;
 
     void processLinks(int pageNo, CmdResponse& response);
     void processText(int pageNo, const char* pattern, CmdResponse& response);
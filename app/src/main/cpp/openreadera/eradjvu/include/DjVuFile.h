@@ -644,6 +644,8 @@ private:
    void	decode(const GP<ByteStream> &str);
    GUTF8String decode_chunk(const GUTF8String &chkid,
      const GP<ByteStream> &str, bool djvi, bool djvu, bool iw44);
+      // Decodes independent layers in helper threads
+   class LayerDecoder;
    int		get_dpi(int w, int h);
 
       // Functions dealing with the shape directory (fgjd)
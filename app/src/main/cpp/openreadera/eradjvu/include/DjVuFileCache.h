@@ -117,6 +117,7 @@ public:
    void clear(void) {}
    void set_max_size(int) {}
    int get_max_size(void) const {return 0;}
+   int get_cur_size(void) const {return 0;}
    void enable(bool en) {}
    bool is_enabled(void) const {return false;}
 } ;
@@ -149,6 +150,9 @@ public:
       /** Returns the maximum allowed size of the cache. */
    int		get_max_size(void) const;
 
+      /** Returns the total size of all items in the cache. */
+   int		get_cur_size(void) const;
+
       /** Enables or disables the cache. See \Ref{is_enabled}() for details
 	  @param en - If {\em en} is TRUE, the cache will be enabled.
 	         Otherwise it will be disabled.
@@ -268,6 +272,12 @@ DjVuFileCache::get_max_size(void) const
    return max_size;
 }
 
+inline int
+DjVuFileCache::get_cur_size(void) const
+{
+   return cur_size;
+}
+
 #endif
 
 inline GP<DjVuFileCache>
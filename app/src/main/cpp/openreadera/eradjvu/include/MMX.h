@@ -64,6 +64,19 @@
 
 #include "DjVuGlobal.h"
 
+// SSE2 is part of both x86 Android ABIs and NEON is mandatory on arm64-v8a
+// and enabled for armeabi-v7a, so the vector code is selected at compile
+// time without runtime detection. Define NO_SIMD to build scalar code only.
+#ifndef NO_SIMD
+# if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define SIMD_SSE2 1
+# elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define SIMD_NEON 1
+# endif
+#endif
+
 #ifdef HAVE_NAMESPACES
 namespace DJVU {
 # ifdef NOT_DEFINED // Just to fool emacs c++ mode
@@ -101,6 +114,14 @@ namespace DJVU {
        Execute the #EMMS# instruction to reset the FPU state.
     \end{description}
 
+    Macro #SIMD_SSE2# or #SIMD_NEON# is defined when the compiler targets
+    a processor with the SSE2 or NEON instruction set.  Code using them
+    includes the intrinsics headers and produces the same results as the
+    baseline code, except when the horizontal IW44 lifting overflows 16
+    bits, which only corrupt coefficients do: the baseline then carries
+    the unwrapped sum into the next step.  Program #simdcheck/build.sh#
+    compares both on random input.
+
     @memo
     Essential support for MMX.
     @author: 
@@ -241,6 +241,13 @@ DDJVUAPI unsigned long
 ddjvu_cache_get_size(ddjvu_context_t *context);
 
 
+/* ddjvu_cache_get_used ---
+   Returns the estimated size of data held by the cache. */
+
+DDJVUAPI unsigned long
+ddjvu_cache_get_used(ddjvu_context_t *context);
+
+
 /* ddjvu_cache_clear ---
    Clears all cached data. */
 
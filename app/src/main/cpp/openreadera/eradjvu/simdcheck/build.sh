@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# Builds simd_check: DjVuLibre sources are compiled twice, scalar (NO_SIMD)
+# and as shipped, and linked into one executable comparing both.
+#
+# Usage: build.sh [cases]
+#   CXX       compiler, e.g. NDK aarch64-linux-android21-clang++ or
+#             armv7a-linux-androideabi21-clang++ (with CXXFLAGS=-mfpu=neon)
+#   CXXFLAGS  extra compiler flags
+#   RUN       command prefix to run the binary, e.g. qemu-aarch64 -L <sysroot>;
+#             set RUN=none to only build (then push to a device and run there)
+#   NEON_EMU  set to 1 on non ARM hosts to build the NEON paths against
+#             neon_emu/arm_neon.h, a scalar model of the used intrinsics.
+#             It checks the NEON algorithms, not the compiler code generation.
+
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+DJVU="$HERE/.."
+OUT="${OUT:-$HERE/out}"
+CXX="${CXX:-c++}"
+FLAGS="-std=c++14 -O2 -DHAVE_CONFIG_H -DTHREADMODEL=POSIXTHREADS -DHAVE_PTHREAD -I$DJVU/include -include cstring $CXXFLAGS"
+if [ "$NEON_EMU" = "1" ]; then
+    SIMD_FLAGS="-U__SSE2__ -D__ARM_NEON -I$HERE/neon_emu"
+    OUT="$OUT-neon-emu"
+fi
+
+mkdir -p "$OUT/scalar" "$OUT/simd"
+for f in "$DJVU"/src/*.cpp; do
+    s=$(basename "$f" .cpp)
+    # Needs libjpeg, simd_check_run.cpp stubs it
+    [ "$s" = "JPEGDecoder" ] && continue
+    $CXX $FLAGS -DNO_SIMD -DNO_MMX -DDJVU=DJVU_SCALAR -c "$f" -o "$OUT/scalar/$s.o" &
+    $CXX $FLAGS $SIMD_FLAGS -c "$f" -o "$OUT/simd/$s.o" &
+    wait
+done
+$CXX $FLAGS -DNO_SIMD -DNO_MMX -DDJVU=DJVU_SCALAR -DSIMD_CHECK_NS=simd_check_scalar \
+    -c "$HERE/simd_check_run.cpp" -o "$OUT/simd_check_scalar.o"
+$CXX $FLAGS $SIMD_FLAGS -DSIMD_CHECK_NS=simd_check_simd \
+    -c "$HERE/simd_check_run.cpp" -o "$OUT/simd_check_simd.o"
+$CXX $FLAGS -c "$HERE/simd_check.cpp" -o "$OUT/simd_check.o"
+rm -f "$OUT/scalar.a" "$OUT/simd.a"
+ar rcs "$OUT/scalar.a" "$OUT"/scalar/*.o
+ar rcs "$OUT/simd.a" "$OUT"/simd/*.o
+# Both copies carry the same extern "C" helpers (DjVuPrintErrorUTF8 etc)
+$CXX -o "$OUT/simd_check" "$OUT/simd_check.o" "$OUT/simd_check_scalar.o" "$OUT/simd_check_simd.o" \
+    "$OUT/scalar.a" "$OUT/simd.a" -Wl,--allow-multiple-definition -pthread
+
+if [ "$RUN" != "none" ]; then
+    $RUN "$OUT/simd_check" "$@"
+fi
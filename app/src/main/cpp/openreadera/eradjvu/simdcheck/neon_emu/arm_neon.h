@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+// Scalar model of the NEON intrinsics used by the DjVu decoder, lane by lane
+// as the ARM reference describes them. Lets build.sh compile and check the
+// NEON paths on hosts without an ARM toolchain (NEON_EMU=1). It says nothing
+// about code generation, the real check is a build for an ARM target.
+
+#ifndef __SIMD_CHECK_ARM_NEON_H__
+#define __SIMD_CHECK_ARM_NEON_H__
+
+#include <cstdint>
+
+template<typename T, int N>
+struct neon_emu_vec
+{
+    T v[N];
+};
+
+typedef neon_emu_vec<int8_t, 8> int8x8_t;
+typedef neon_emu_vec<uint8_t, 8> uint8x8_t;
+typedef neon_emu_vec<int8_t, 16> int8x16_t;
+typedef neon_emu_vec<uint8_t, 16> uint8x16_t;
+typedef neon_emu_vec<int16_t, 4> int16x4_t;
+typedef neon_emu_vec<int16_t, 8> int16x8_t;
+typedef neon_emu_vec<uint16_t, 8> uint16x8_t;
+typedef neon_emu_vec<int32_t, 4> int32x4_t;
+
+struct int16x8x2_t { int16x8_t val[2]; };
+struct int8x16x3_t { int8x16_t val[3]; };
+struct uint8x16x3_t { uint8x16_t val[3]; };
+
+// Lane arithmetic wraps like the hardware does, done on unsigned types
+#define NEON_EMU_WRAP(T, expr) ((T) (uint32_t) (expr))
+
+template<typename T, int N>
+static inline neon_emu_vec<T, N / 2> neon_emu_half(const neon_emu_vec<T, N>& a, int from)
+{
+    neon_emu_vec<T, N / 2> r;
+    for (int i = 0; i < N / 2; i++) r.v[i] = a.v[from + i];
+    return r;
+}
+
+template<typename T, int N>
+static inline neon_emu_vec<T, N * 2> neon_emu_combine(const neon_emu_vec<T, N>& a, const neon_emu_vec<T, N>& b)
+{
+    neon_emu_vec<T, N * 2> r;
+    for (int i = 0; i < N; i++) { r.v[i] = a.v[i]; r.v[N + i] = b.v[i]; }
+    return r;
+}
+
+static inline int16x4_t vget_low_s16(int16x8_t a) { return neon_emu_half(a, 0); }
+static inline int16x4_t vget_high_s16(int16x8_t a) { return neon_emu_half(a, 4); }
+static inline int8x8_t vget_low_s8(int8x16_t a) { return neon_emu_half(a, 0); }
+static inline int8x8_t vget_high_s8(int8x16_t a) { return neon_emu_half(a, 8); }
+static inline uint8x8_t vget_low_u8(uint8x16_t a) { return neon_emu_half(a, 0); }
+static inline uint8x8_t vget_high_u8(uint8x16_t a) { return neon_emu_half(a, 8); }
+static inline int16x8_t vcombine_s16(int16x4_t a, int16x4_t b) { return neon_emu_combine(a, b); }
+static inline uint8x16_t vcombine_u8(uint8x8_t a, uint8x8_t b) { return neon_emu_combine(a, b); }
+
+static inline int16x8_t vdupq_n_s16(int16_t x) { int16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = x; return r; }
+static inline int32x4_t vdupq_n_s32(int32_t x) { int32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = x; return r; }
+
+static inline int16x8_t vld1q_s16(const int16_t* p) { int16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = p[i]; return r; }
+static inline uint8x16_t vld1q_u8(const uint8_t* p) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = p[i]; return r; }
+static inline void vst1q_s16(int16_t* p, int16x8_t a) { for (int i = 0; i < 8; i++) p[i] = a.v[i]; }
+static inline void vst1q_u8(uint8_t* p, uint8x16_t a) { for (int i = 0; i < 16; i++) p[i] = a.v[i]; }
+
+static inline int16x8x2_t vld2q_s16(const int16_t* p)
+{
+    int16x8x2_t r;
+    for (int i = 0; i < 8; i++) { r.val[0].v[i] = p[2 * i]; r.val[1].v[i] = p[2 * i + 1]; }
+    return r;
+}
+
+static inline void vst2q_s16(int16_t* p, int16x8x2_t a)
+{
+    for (int i = 0; i < 8; i++) { p[2 * i] = a.val[0].v[i]; p[2 * i + 1] = a.val[1].v[i]; }
+}
+
+static inline int8x16x3_t vld3q_s8(const int8_t* p)
+{
+    int8x16x3_t r;
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++) r.val[k].v[i] = p[3 * i + k];
+    return r;
+}
+
+static inline void vst3q_u8(uint8_t* p, uint8x16x3_t a)
+{
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++) p[3 * i + k] = a.val[k].v[i];
+}
+
+static inline int16x8_t vaddq_s16(int16x8_t a, int16x8_t b) { for (int i = 0; i < 8; i++) a.v[i] = NEON_EMU_WRAP(int16_t, a.v[i] + b.v[i]); return a; }
+static inline int16x8_t vsubq_s16(int16x8_t a, int16x8_t b) { for (int i = 0; i < 8; i++) a.v[i] = NEON_EMU_WRAP(int16_t, a.v[i] - b.v[i]); return a; }
+static inline int32x4_t vaddq_s32(int32x4_t a, int32x4_t b) { for (int i = 0; i < 4; i++) a.v[i] = NEON_EMU_WRAP(int32_t, (uint32_t) a.v[i] + (uint32_t) b.v[i]); return a; }
+static inline int32x4_t vsubq_s32(int32x4_t a, int32x4_t b) { for (int i = 0; i < 4; i++) a.v[i] = NEON_EMU_WRAP(int32_t, (uint32_t) a.v[i] - (uint32_t) b.v[i]); return a; }
+static inline int16x8_t vmulq_n_s16(int16x8_t a, int16_t b) { for (int i = 0; i < 8; i++) a.v[i] = NEON_EMU_WRAP(int16_t, a.v[i] * b); return a; }
+static inline int32x4_t vmulq_n_s32(int32x4_t a, int32_t b) { for (int i = 0; i < 4; i++) a.v[i] = NEON_EMU_WRAP(int32_t, (uint32_t) a.v[i] * (uint32_t) b); return a; }
+
+static inline int32x4_t vaddl_s16(int16x4_t a, int16x4_t b) { int32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = (int32_t) a.v[i] + b.v[i]; return r; }
+static inline uint16x8_t vsubl_u8(uint8x8_t a, uint8x8_t b) { uint16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = (uint16_t) (a.v[i] - b.v[i]); return r; }
+static inline int16x8_t vmovl_s8(int8x8_t a) { int16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = a.v[i]; return r; }
+static inline uint16x8_t vmovl_u8(uint8x8_t a) { uint16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = a.v[i]; return r; }
+static inline int16x4_t vmovn_s32(int32x4_t a) { int16x4_t r; for (int i = 0; i < 4; i++) r.v[i] = (int16_t) (uint16_t) (uint32_t) a.v[i]; return r; }
+
+static inline uint8x8_t vqmovun_s16(int16x8_t a)
+{
+    uint8x8_t r;
+    for (int i = 0; i < 8; i++) r.v[i] = a.v[i] < 0 ? 0 : a.v[i] > 255 ? 255 : (uint8_t) a.v[i];
+    return r;
+}
+
+static inline int16x8_t vreinterpretq_s16_u16(uint16x8_t a) { int16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = (int16_t) a.v[i]; return r; }
+
+// Shifts: right shifts are arithmetic, vshlq_s32 shifts right by negative counts
+static inline int16x8_t vshrq_n_s16(int16x8_t a, int n) { for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (a.v[i] >> n); return a; }
+static inline int16x8_t vshlq_n_s16(int16x8_t a, int n) { for (int i = 0; i < 8; i++) a.v[i] = NEON_EMU_WRAP(int16_t, (uint32_t) a.v[i] << n); return a; }
+static inline int16x8_t vrshrq_n_s16(int16x8_t a, int n) { for (int i = 0; i < 8; i++) a.v[i] = (int16_t) (((int32_t) a.v[i] + (1 << (n - 1))) >> n); return a; }
+
+static inline int32x4_t vshlq_s32(int32x4_t a, int32x4_t b)
+{
+    for (int i = 0; i < 4; i++) {
+        int n = (int8_t) b.v[i];
+        a.v[i] = n >= 0 ? NEON_EMU_WRAP(int32_t, (uint32_t) a.v[i] << n) : a.v[i] >> (n < -31 ? 31 : -n);
+    }
+    return a;
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+// Compares the SIMD paths of the DjVu decoder (MMX.h SIMD_SSE2 / SIMD_NEON)
+// with the scalar code on random input, results must be bit exact.
+// Build and run with build.sh, exit code is 1 on any mismatch.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "simd_check.h"
+
+// Same sequence on every platform, unlike rand()
+static uint32_t seed = 2463534242u;
+
+static int next(int n)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (int) (seed % (uint32_t) n);
+}
+
+static int report(const char* name, int cases, int failed)
+{
+    printf("%-14s %6d cases, %d mismatched\n", name, cases, failed);
+    return failed;
+}
+
+// Coefficients stay within +-COEFF_RANGE, so the 16 bit lifting sums of the
+// horizontal pass never overflow. The baseline keeps the unwrapped value when
+// they do, which only happens with corrupt data.
+#define COEFF_RANGE 1024
+
+static int checkBackward(int cases)
+{
+    int failed = 0;
+    for (int i = 0; i < cases; i++) {
+        int w = 1 + next(300);
+        int h = 1 + next(200);
+        int rowsize = w + next(17);
+        int begin = 2 << next(5);
+        int end = 1 << next(3);
+        if (end >= begin) {
+            end = 1;
+        }
+        std::vector<short> a((size_t) rowsize * h);
+        for (size_t k = 0; k < a.size(); k++) {
+            a[k] = (short) (next(2 * COEFF_RANGE + 1) - COEFF_RANGE);
+        }
+        std::vector<short> b = a;
+        simd_check_scalar::backward(a, w, h, rowsize, begin, end);
+        simd_check_simd::backward(b, w, h, rowsize, begin, end);
+        if (a != b) {
+            if (failed++ < 5) {
+                printf("backward: w=%d h=%d rowsize=%d begin=%d end=%d\n", w, h, rowsize, begin, end);
+            }
+        }
+    }
+    return report("backward", cases, failed);
+}
+
+static int checkYCbCr(int cases)
+{
+    int failed = 0;
+    for (int i = 0; i < cases; i++) {
+        int w = 1 + next(100);
+        int h = 1 + next(8);
+        std::vector<unsigned char> a((size_t) w * h * 3);
+        for (size_t k = 0; k < a.size(); k++) {
+            a[k] = (unsigned char) next(256);
+        }
+        std::vector<unsigned char> b = a;
+        simd_check_scalar::ycbcr_to_rgb(a, w, h);
+        simd_check_simd::ycbcr_to_rgb(b, w, h);
+        if (a != b) {
+            if (failed++ < 5) {
+                printf("ycbcr_to_rgb: w=%d h=%d\n", w, h);
+            }
+        }
+    }
+    return report("ycbcr_to_rgb", cases, failed);
+}
+
+static int checkScale(int cases, bool pixmap)
+{
+    int failed = 0;
+    int bpp = pixmap ? 3 : 1;
+    for (int i = 0; i < cases; i++) {
+        int w = 1 + next(120);
+        int h = 1 + next(120);
+        int ow = 1 + next(240);
+        int oh = 1 + next(240);
+        std::vector<unsigned char> in((size_t) w * h * bpp);
+        for (size_t k = 0; k < in.size(); k++) {
+            in[k] = (unsigned char) next(256);
+        }
+        std::vector<unsigned char> a, b;
+        if (pixmap) {
+            a = simd_check_scalar::scale_pixmap(in, w, h, ow, oh);
+            b = simd_check_simd::scale_pixmap(in, w, h, ow, oh);
+        } else {
+            a = simd_check_scalar::scale_bitmap(in, w, h, ow, oh);
+            b = simd_check_simd::scale_bitmap(in, w, h, ow, oh);
+        }
+        if (a != b) {
+            if (failed++ < 5) {
+                printf("%s: %dx%d to %dx%d\n", pixmap ? "scale_pixmap" : "scale_bitmap", w, h, ow, oh);
+            }
+        }
+    }
+    return report(pixmap ? "scale_pixmap" : "scale_bitmap", cases, failed);
+}
+
+int main(int argc, char* argv[])
+{
+    int cases = argc > 1 ? atoi(argv[1]) : 2000;
+    printf("scalar: %s, simd: %s\n", simd_check_scalar::simd_name(), simd_check_simd::simd_name());
+    if (strcmp(simd_check_simd::simd_name(), "none") == 0) {
+        printf("SIMD build has no vector code, check compiler flags\n");
+        return 1;
+    }
+    int failed = 0;
+    failed += checkBackward(cases);
+    failed += checkYCbCr(cases);
+    failed += checkScale(cases, true);
+    failed += checkScale(cases, false);
+    return failed > 0 ? 1 : 0;
+}
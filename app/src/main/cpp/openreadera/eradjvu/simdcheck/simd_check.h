@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#ifndef __SIMD_CHECK_H__
+#define __SIMD_CHECK_H__
+
+#include <vector>
+
+/**
+ * Entry points of one build of the DjVu decoder sources.
+ * simd_check_run.cpp is compiled twice, once per namespace: DjVuLibre code
+ * in simd_check_scalar is built with NO_SIMD, in simd_check_simd as shipped.
+ */
+#define SIMD_CHECK_DECLARE(ns)                                                   \
+namespace ns {                                                                   \
+    /* Instruction set the build selected in MMX.h */                            \
+    const char* simd_name();                                                     \
+    /* In place IW44 backward transform of w x h coefficients */                 \
+    void backward(std::vector<short>& coeffs, int w, int h, int rowsize,         \
+            int begin, int end);                                                 \
+    /* In place YCbCr to RGB conversion of w x h GPixels (3 bytes each) */       \
+    void ycbcr_to_rgb(std::vector<unsigned char>& pixels, int w, int h);         \
+    /* Scales w x h GPixels to ow x oh */                                         \
+    std::vector<unsigned char> scale_pixmap(const std::vector<unsigned char>& in,\
+            int w, int h, int ow, int oh);                                       \
+    /* Scales w x h gray bitmap bytes (256 grays) to ow x oh */                  \
+    std::vector<unsigned char> scale_bitmap(const std::vector<unsigned char>& in,\
+            int w, int h, int ow, int oh);                                       \
+}
+
+SIMD_CHECK_DECLARE(simd_check_scalar)
+SIMD_CHECK_DECLARE(simd_check_simd)
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+// Compiled once per DjVuLibre build, see build.sh:
+// SIMD_CHECK_NS names the entry points namespace and DJVU is redefined,
+// so the scalar and SIMD copies of DjVuLibre link into one executable.
+
+#include <cstring>
+
+// Declares IW44Image::Transform::Decode
+#define IW44IMAGE_IMPLIMENTATION
+
+#include "GBitmap.h"
+#include "GPixmap.h"
+#include "GRect.h"
+#include "GScaler.h"
+#include "IW44Image.h"
+#include "JPEGDecoder.h"
+#include "MMX.h"
+#include "simd_check.h"
+
+using namespace DJVU;
+
+// JPEGDecoder.cpp is not built to keep libjpeg out, nothing here decodes JPEG
+void JPEGDecoder::decode(ByteStream&, GPixmap&)
+{
+    G_THROW("JPEG is not supported by simd_check");
+}
+
+namespace SIMD_CHECK_NS {
+
+const char* simd_name()
+{
+#if defined(SIMD_SSE2)
+    return "SSE2";
+#elif defined(SIMD_NEON)
+    return "NEON";
+#else
+    return "none";
+#endif
+}
+
+void backward(std::vector<short>& coeffs, int w, int h, int rowsize, int begin, int end)
+{
+    IW44Image::Transform::Decode::backward(coeffs.data(), w, h, rowsize, begin, end);
+}
+
+void ycbcr_to_rgb(std::vector<unsigned char>& pixels, int w, int h)
+{
+    IW44Image::Transform::Decode::YCbCr_to_RGB((GPixel*) pixels.data(), w, h, w);
+}
+
+std::vector<unsigned char> scale_pixmap(const std::vector<unsigned char>& in,
+        int w, int h, int ow, int oh)
+{
+    GP<GPixmap> input = GPixmap::create(h, w);
+    for (int y = 0; y < h; y++) {
+        memcpy((*input)[y], &in[y * w * 3], w * 3);
+    }
+    GP<GPixmap> output = GPixmap::create();
+    GP<GPixmapScaler> scaler = GPixmapScaler::create(w, h, ow, oh);
+    scaler->scale(GRect(0, 0, w, h), *input, GRect(0, 0, ow, oh), *output);
+    std::vector<unsigned char> out(ow * oh * 3);
+    for (int y = 0; y < oh; y++) {
+        memcpy(&out[y * ow * 3], (*output)[y], ow * 3);
+    }
+    return out;
+}
+
+std::vector<unsigned char> scale_bitmap(const std::vector<unsigned char>& in,
+        int w, int h, int ow, int oh)
+{
+    GP<GBitmap> input = GBitmap::create(h, w);
+    input->set_grays(256);
+    for (int y = 0; y < h; y++) {
+        memcpy((*input)[y], &in[y * w], w);
+    }
+    GP<GBitmap> output = GBitmap::create();
+    GP<GBitmapScaler> scaler = GBitmapScaler::create(w, h, ow, oh);
+    scaler->scale(GRect(0, 0, w, h), *input, GRect(0, 0, ow, oh), *output);
+    std::vector<unsigned char> out(ow * oh);
+    for (int y = 0; y < oh; y++) {
+        memcpy(&out[y * ow], (*output)[y], ow);
+    }
+    return out;
+}
+
+} // namespace SIMD_CHECK_NS
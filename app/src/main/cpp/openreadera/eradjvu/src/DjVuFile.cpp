@@ -1213,6 +1213,160 @@ DjVuFile::set_decode_codec(GP<GPixmap> (*codec)(ByteStream &bs))
   djvu_decode_codec=codec;
 }
 
+
+// Sjbz and FG44 chunks do not depend on the BG44 chunks following them,
+// so decode() hands them to helper threads and goes on with the background.
+// A compound page is then decoded in the time of its slowest layer.
+class DjVuFile::LayerDecoder
+{
+public:
+  LayerDecoder(DjVuFile *file) : file(file), pending(0) {}
+  ~LayerDecoder();
+  static bool is_layer(const GUTF8String &chkid)
+    { return chkid=="Sjbz" || chkid=="FG44"; }
+  // Copies chunk data and starts decoding it
+  void start(const GUTF8String &chkid, int chksize, ByteStream &bs);
+  // Waits for all layers, stores them into the file and returns
+  // chunk descriptions. Rethrows the error of a failed layer.
+  GUTF8String finish(void);
+private:
+  struct Job
+  {
+    LayerDecoder *owner;
+    GUTF8String chkid;
+    int chksize;
+    GP<ByteStream> data;
+    GThread thread;
+    GP<JB2Image> fgjb;
+    GP<GPixmap> fgpm;
+    GUTF8String desc;
+    GException error;
+    bool failed;
+  };
+  DjVuFile *file;
+  GList<Job*> jobs;
+  GMonitor mon;
+  int pending;
+  static void static_run(void *arg);
+  void run(Job *job);
+  void wait(void);
+};
+
+DjVuFile::LayerDecoder::~LayerDecoder()
+{
+  wait();
+  for(GPosition pos=jobs;pos;++pos)
+    delete jobs[pos];
+}
+
+void
+DjVuFile::LayerDecoder::start(const GUTF8String &chkid, int chksize, ByteStream &bs)
+{
+  Job *job=new Job();
+  job->owner=this;
+  job->chkid=chkid;
+  job->chksize=chksize;
+  job->failed=false;
+  job->data=ByteStream::create();
+  job->data->copy(bs);
+  job->data->seek(0);
+  jobs.append(job);
+  mon.enter();
+  pending++;
+  mon.leave();
+  if (job->thread.create(static_run, job) < 0)
+    run(job);
+}
+
+void
+DjVuFile::LayerDecoder::static_run(void *arg)
+{
+  Job *job=(Job*)arg;
+  job->owner->run(job);
+}
+
+void
+DjVuFile::LayerDecoder::run(Job *job)
+{
+  G_TRY
+  {
+    if (job->chkid=="Sjbz")
+    {
+      GP<JB2Image> fgjb=JB2Image::create();
+      // ---- begin hack
+      if (file->info && file->info->version <=18)
+        fgjb->reproduce_old_bug = true;
+      // ---- end hack
+      fgjb->decode(job->data, static_get_fgjd, (void*)file);
+      job->fgjb=fgjb;
+      job->desc.format( ERR_MSG("DjVuFile.fg_mask") "\t%d\t%d\t%d",
+        fgjb->get_width(), fgjb->get_height(),
+        file->get_dpi(fgjb->get_width(), fgjb->get_height()));
+    }
+    else
+    {
+      GP<IW44Image> gfg44=IW44Image::create_decode(IW44Image::COLOR);
+      IW44Image &fg44=*gfg44;
+      fg44.decode_chunk(job->data);
+      job->fgpm=fg44.get_pixmap();
+      job->desc.format( ERR_MSG("DjVuFile.IW44_fg") "\t%d\t%d\t%d",
+        fg44.get_width(), fg44.get_height(),
+        file->get_dpi(fg44.get_width(), fg44.get_height()));
+    }
+  }
+  G_CATCH(ex)
+  {
+    job->error=ex;
+    job->failed=true;
+  }
+  G_ENDCATCH;
+  job->data=0;
+  // Job is not touched after this point
+  mon.enter();
+  pending--;
+  mon.broadcast();
+  mon.leave();
+}
+
+void
+DjVuFile::LayerDecoder::wait(void)
+{
+  mon.enter();
+  while (pending > 0)
+    mon.wait();
+  mon.leave();
+}
+
+GUTF8String
+DjVuFile::LayerDecoder::finish(void)
+{
+  wait();
+  GUTF8String description;
+  for(GPosition pos=jobs;pos;++pos)
+  {
+    Job *job=jobs[pos];
+    if (job->failed)
+      G_RETHROW(job->error);
+    if (job->fgjb)
+    {
+      if (file->fgjb)
+        G_THROW( ERR_MSG("DjVuFile.dupl_Sxxx") );
+      file->fgjb=job->fgjb;
+    }
+    if (job->fgpm)
+    {
+      if (file->fgpm || file->fgbc)
+        G_THROW( ERR_MSG("DjVuFile.dupl_foregrnd") );
+      file->fgpm=job->fgpm;
+    }
+    GUTF8String desc;
+    desc.format("\t%5.1f\t%s", job->chksize/1024.0, (const char*)job->chkid);
+    description = description + job->desc + desc + "\n";
+    file->get_portcaster()->notify_chunk_done(file, job->chkid);
+  }
+  return description;
+}
+
 void
 DjVuFile::decode(const GP<ByteStream> &gbs)
 {
@@ -1243,6 +1397,7 @@ DjVuFile::decode(const GP<ByteStream> &gbs)
   int size_so_far=iff.tell();
   int chunks=0;
   int last_chunk=0;
+  LayerDecoder layers(this);
   G_TRY
   {
     int chunks_left=(recover_errors>SKIP_PAGES)?chunks_number:(-1);
@@ -1251,6 +1406,17 @@ DjVuFile::decode(const GP<ByteStream> &gbs)
     {
       chunks++;
 
+      // Hand independent layers to helper threads
+      if ((djvu || djvi) && LayerDecoder::is_layer(chkid))
+      {
+        if (get_count()==1)
+          G_THROW( DataPool::Stop );
+        layers.start(chkid, chksize, *iff.get_bytestream());
+        iff.seek_close_chunk();
+        size_so_far=iff.tell();
+        continue;
+      }
+
       // Decode and get chunk description
       GUTF8String str = decode_chunk(chkid, iff.get_bytestream(), djvi, djvu, iw44);
       // Add parameters to the chunk description to give the size and chunk id
@@ -1280,6 +1446,18 @@ DjVuFile::decode(const GP<ByteStream> &gbs)
     }
   }
   G_ENDCATCH;
+  // Collect layers decoded by helper threads
+  G_TRY
+  {
+    description = description + layers.finish();
+  }
+  G_CATCH(ex)
+  {
+    if (!ex.cmp_cause(DataPool::Stop))
+      G_RETHROW;
+    report_error(ex,(recover_errors <= SKIP_PAGES));
+  }
+  G_ENDCATCH;
   
   // Record file size
   file_size=size_so_far;
@@ -147,8 +147,9 @@ public:
 // MMX implementation for vertical transforms only.
 // Speedup is basically related to faster memory transfer
 // The IW44 transform is not CPU bound, it is memory bound.
+// Superseded by the SSE2 helpers when they are available.
 
-#ifdef MMX
+#if defined(MMX) && !defined(SIMD_SSE2)
 
 static const short w9[]  = {9,9,9,9};
 static const short w1[]  = {1,1,1,1};
@@ -241,7 +242,191 @@ mmx_bv_2 ( short* &q, short* e, int s, int s3 )
       q += 4;
     }
 }
-#endif /* MMX */
+#endif /* MMX && !SIMD_SSE2 */
+
+
+//////////////////////////////////////////////////////
+// SSE2 AND NEON IMPLEMENTATION HELPERS
+//////////////////////////////////////////////////////
+
+
+// Note:
+// Only the finest scale (scale==1) is vectorized, coefficients are
+// contiguous there and it holds three quarters of the work.
+// Sums are computed on 32 bits and truncated to 16 bits when stored,
+// so the results are identical to the baseline code below, unless
+// horizontal lifting overflows 16 bits (see MMX.h).
+
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+
+#if defined(SIMD_SSE2)
+
+// Sign extends even (low) or odd (high) 16 bit halves of 32 bit lanes
+static inline __m128i sse2_even(__m128i v) { return _mm_srai_epi32(_mm_slli_epi32(v,16),16); }
+static inline __m128i sse2_odd(__m128i v) { return _mm_srai_epi32(v,16); }
+static inline __m128i sse2_load(const short *p) { return _mm_loadu_si128((const __m128i*)p); }
+
+// Returns (9*(b+c)-a-d+rnd)>>shift on 32 bits for 4 lanes
+static inline __m128i
+sse2_lift(__m128i a, __m128i b, __m128i c, __m128i d, int rnd, int shift)
+{
+  __m128i x = _mm_add_epi32(b, c);
+  x = _mm_add_epi32(_mm_slli_epi32(x, 3), x);
+  x = _mm_sub_epi32(x, _mm_add_epi32(a, d));
+  return _mm_srai_epi32(_mm_add_epi32(x, _mm_set1_epi32(rnd)), shift);
+}
+
+// Same for 8 rows coefficients, truncated to 16 bits
+static inline __m128i
+sse2_lift_v(const short *q, int s, int s3, int rnd, int shift)
+{
+  const __m128i w9 = _mm_set1_epi16(9);
+  const __m128i w1 = _mm_set1_epi16(1);
+  const __m128i vr = _mm_set1_epi32(rnd);
+  __m128i a = sse2_load(q-s3);
+  __m128i b = sse2_load(q-s);
+  __m128i c = sse2_load(q+s);
+  __m128i d = sse2_load(q+s3);
+  __m128i lo = _mm_sub_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b, c), w9),
+                             _mm_madd_epi16(_mm_unpacklo_epi16(a, d), w1));
+  __m128i hi = _mm_sub_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b, c), w9),
+                             _mm_madd_epi16(_mm_unpackhi_epi16(a, d), w1));
+  lo = sse2_even(_mm_srai_epi32(_mm_add_epi32(lo, vr), shift));
+  hi = sse2_even(_mm_srai_epi32(_mm_add_epi32(hi, vr), shift));
+  return _mm_packs_epi32(lo, hi);
+}
+
+#else /* SIMD_NEON */
+
+// Returns (9*(b+c)-a-d+rnd)>>shift truncated to 16 bits for 8 lanes
+static inline int16x8_t
+neon_lift(int16x8_t a, int16x8_t b, int16x8_t c, int16x8_t d, int rnd, int shift)
+{
+  const int32x4_t vr = vdupq_n_s32(rnd);
+  const int32x4_t vs = vdupq_n_s32(-shift);
+  int32x4_t lo = vmulq_n_s32(vaddl_s16(vget_low_s16(b), vget_low_s16(c)), 9);
+  int32x4_t hi = vmulq_n_s32(vaddl_s16(vget_high_s16(b), vget_high_s16(c)), 9);
+  lo = vsubq_s32(lo, vaddl_s16(vget_low_s16(a), vget_low_s16(d)));
+  hi = vsubq_s32(hi, vaddl_s16(vget_high_s16(a), vget_high_s16(d)));
+  lo = vshlq_s32(vaddq_s32(lo, vr), vs);
+  hi = vshlq_s32(vaddq_s32(hi, vr), vs);
+  return vcombine_s16(vmovn_s32(lo), vmovn_s32(hi));
+}
+
+#endif
+
+static void
+simd_bv_1 ( short* &q, short* e, int s, int s3 )
+{
+  while (q+8 <= e)
+    {
+#if defined(SIMD_SSE2)
+      __m128i x = sse2_lift_v(q, s, s3, 16, 5);
+      _mm_storeu_si128((__m128i*)q, _mm_sub_epi16(sse2_load(q), x));
+#else
+      int16x8_t x = neon_lift(vld1q_s16(q-s3), vld1q_s16(q-s),
+                              vld1q_s16(q+s), vld1q_s16(q+s3), 16, 5);
+      vst1q_s16(q, vsubq_s16(vld1q_s16(q), x));
+#endif
+      q += 8;
+    }
+}
+
+static void
+simd_bv_2 ( short* &q, short* e, int s, int s3 )
+{
+  while (q+8 <= e)
+    {
+#if defined(SIMD_SSE2)
+      __m128i x = sse2_lift_v(q, s, s3, 8, 4);
+      _mm_storeu_si128((__m128i*)q, _mm_add_epi16(sse2_load(q), x));
+#else
+      int16x8_t x = neon_lift(vld1q_s16(q-s3), vld1q_s16(q-s),
+                              vld1q_s16(q+s), vld1q_s16(q+s3), 8, 4);
+      vst1q_s16(q, vaddq_s16(vld1q_s16(q), x));
+#endif
+      q += 8;
+    }
+}
+
+// Horizontal transform of one row with scale==1, requires w>=16.
+// The baseline loop interleaves two independent passes which are
+// separated here: even samples are lifted from the original odd
+// samples, then odd samples are interpolated from the new even ones.
+static void
+simd_bh_1 ( short *q, int w )
+{
+  int x;
+  // 1-Lifting, odd samples outside of the row count as zero
+  for (x=0; x<4; x+=2)
+    {
+      int a = (x>0 ? (int)q[x-1] : 0) + (int)q[x+1];
+      int b = (x>2 ? (int)q[x-3] : 0) + (int)q[x+3];
+      q[x] -= (((a<<3)+a-b+16)>>5);
+    }
+#if defined(SIMD_SSE2)
+  // 32 bit lanes hold (even,odd) pairs, 4 even samples per step
+  for (; x+9 < w; x+=8)
+    {
+      __m128i v = sse2_load(q+x);
+      __m128i d = sse2_lift(sse2_odd(sse2_load(q+x-4)), sse2_odd(sse2_load(q+x-2)),
+                            sse2_odd(v), sse2_odd(sse2_load(q+x+2)), 16, 5);
+      d = _mm_and_si128(_mm_sub_epi32(v, d), _mm_set1_epi32(0xffff));
+      v = _mm_or_si128(_mm_andnot_si128(_mm_set1_epi32(0xffff), v), d);
+      _mm_storeu_si128((__m128i*)(q+x), v);
+    }
+#else
+  // 8 even samples per step
+  for (; x+17 < w; x+=16)
+    {
+      int16x8x2_t v = vld2q_s16(q+x);
+      int16x8_t d = neon_lift(vld2q_s16(q+x-4).val[1], vld2q_s16(q+x-2).val[1],
+                              v.val[1], vld2q_s16(q+x+2).val[1], 16, 5);
+      v.val[0] = vsubq_s16(v.val[0], d);
+      vst2q_s16(q+x, v);
+    }
+#endif
+  for (; x<w; x+=2)
+    {
+      int a = (int)q[x-1] + (x+1<w ? (int)q[x+1] : 0);
+      int b = (int)q[x-3] + (x+3<w ? (int)q[x+3] : 0);
+      q[x] -= (((a<<3)+a-b+16)>>5);
+    }
+  // 2-Interpolation
+  q[1] += (((int)q[0]+(int)q[2]+1)>>1);
+  x = 3;
+#if defined(SIMD_SSE2)
+  for (; x+10 < w; x+=8)
+    {
+      __m128i v = sse2_load(q+x-1);
+      __m128i d = sse2_lift(sse2_even(sse2_load(q+x-3)), sse2_even(v),
+                            sse2_even(sse2_load(q+x+1)), sse2_even(sse2_load(q+x+3)), 8, 4);
+      d = _mm_slli_epi32(_mm_add_epi32(sse2_odd(v), d), 16);
+      v = _mm_or_si128(_mm_and_si128(_mm_set1_epi32(0xffff), v), d);
+      _mm_storeu_si128((__m128i*)(q+x-1), v);
+    }
+#else
+  for (; x+18 < w; x+=16)
+    {
+      int16x8x2_t v = vld2q_s16(q+x-1);
+      int16x8_t d = neon_lift(vld2q_s16(q+x-3).val[0], v.val[0],
+                              vld2q_s16(q+x+1).val[0], vld2q_s16(q+x+3).val[0], 8, 4);
+      v.val[1] = vaddq_s16(v.val[1], d);
+      vst2q_s16(q+x-1, v);
+    }
+#endif
+  for (; x+3 < w; x+=2)
+    {
+      int a = (int)q[x-1] + (int)q[x+1];
+      int b = (int)q[x-3] + (int)q[x+3];
+      q[x] += (((a<<3)+a-b+8)>>4);
+    }
+  // Last odd sample mirrors its left neighbour
+  for (; x < w; x+=2)
+    q[x] += (((int)q[x-1]+(int)q[x+1<w ? x+1 : x-1]+1)>>1);
+}
+
+#endif /* SIMD_SSE2 || SIMD_NEON */
 
 static void 
 filter_bv(short *p, int w, int h, int rowsize, int scale)
@@ -259,7 +444,10 @@ filter_bv(short *p, int w, int h, int rowsize, int scale)
         if (y>=3 && y+3<h)
           {
             // Generic case
-#ifdef MMX
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+            if (scale==1)
+              simd_bv_1(q, e, s, s3);
+#elif defined(MMX)
             if (scale==1 && MMXControl::mmxflag>0)
               mmx_bv_1(q, e, s, s3);
 #endif
@@ -321,7 +509,10 @@ filter_bv(short *p, int w, int h, int rowsize, int scale)
         if (y>=6 && y<h)
           {
             // Generic case
-#ifdef MMX
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+            if (scale==1)
+              simd_bv_2(q, e, s, s3);
+#elif defined(MMX)
             if (scale==1 && MMXControl::mmxflag>0)
               mmx_bv_2(q, e, s, s3);
 #endif
@@ -360,6 +551,15 @@ filter_bh(short *p, int w, int h, int rowsize, int scale)
   rowsize *= scale;
   while (y<h)
     {
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+      if (scale==1 && w>=16)
+        {
+          simd_bh_1(p, w);
+          y += 1;
+          p += rowsize;
+          continue;
+        }
+#endif
       short *q = p;
       short *e = p+w;
       int a0=0, a1=0, a2=0, a3=0;
@@ -1902,6 +2102,23 @@ IW44Image::Transform::Decode::backward(short *p, int w, int h, int rowsize, int
 // COLOR TRANSFORM 
 //////////////////////////////////////////////////////
 
+#if defined(SIMD_NEON)
+// Pigeon transform of 8 pixels, see below
+static inline void
+neon_YCbCr_to_RGB(int8x8_t y8, int8x8_t b8, int8x8_t r8,
+                  uint8x8_t &tr, uint8x8_t &tg, uint8x8_t &tb)
+{
+  int16x8_t y = vaddq_s16(vmovl_s8(y8), vdupq_n_s16(128));
+  int16x8_t b = vmovl_s8(b8);
+  int16x8_t r = vmovl_s8(r8);
+  int16x8_t t2 = vaddq_s16(r, vshrq_n_s16(r, 1));
+  int16x8_t t3 = vsubq_s16(y, vshrq_n_s16(b, 2));
+  tr = vqmovun_s16(vaddq_s16(y, t2));
+  tg = vqmovun_s16(vsubq_s16(t3, vshrq_n_s16(t2, 1)));
+  tb = vqmovun_s16(vaddq_s16(t3, vshlq_n_s16(b, 1)));
+}
+#endif
+
 /* Converts YCbCr to RGB. */
 void 
 IW44Image::Transform::Decode::YCbCr_to_RGB(GPixel *p, int w, int h, int rowsize)
@@ -1909,7 +2126,25 @@ IW44Image::Transform::Decode::YCbCr_to_RGB(GPixel *p, int w, int h, int rowsize)
   for (int i=0; i<h; i++,p+=rowsize)
     {
       GPixel *q = p;
-      for (int j=0; j<w; j++,q++)
+      int j = 0;
+#if defined(SIMD_NEON)
+      // GPixel is three bytes: y, cb, cr are stored in b, g, r
+      for (; j+16<=w; j+=16,q+=16)
+        {
+          int8x16x3_t v = vld3q_s8((signed char*)q);
+          uint8x8_t r0, g0, b0, r1, g1, b1;
+          neon_YCbCr_to_RGB(vget_low_s8(v.val[0]), vget_low_s8(v.val[1]),
+                            vget_low_s8(v.val[2]), r0, g0, b0);
+          neon_YCbCr_to_RGB(vget_high_s8(v.val[0]), vget_high_s8(v.val[1]),
+                            vget_high_s8(v.val[2]), r1, g1, b1);
+          uint8x16x3_t o;
+          o.val[0] = vcombine_u8(b0, b1);
+          o.val[1] = vcombine_u8(g0, g1);
+          o.val[2] = vcombine_u8(r0, r1);
+          vst3q_u8((unsigned char*)q, o);
+        }
+#endif
+      for (; j<w; j++,q++)
         {
           signed char y = ((signed char*)q)[0];
           signed char b = ((signed char*)q)[1];
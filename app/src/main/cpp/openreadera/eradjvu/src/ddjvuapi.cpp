@@ -210,6 +210,7 @@ struct DJVUNS ddjvu_page_s : public ddjvu_job_s
   // virtual job functions:
   virtual ddjvu_status_t status();
   virtual void release();
+  virtual void stop();
   // virtual port functions:
   virtual bool inherits(const GUTF8String&) const;
   virtual bool notify_error(const DjVuPort*, const GUTF8String&);  
@@ -550,6 +551,23 @@ ddjvu_cache_get_size(ddjvu_context_t *ctx)
   return 0;
 }
 
+DDJVUAPI unsigned long
+ddjvu_cache_get_used(ddjvu_context_t *ctx)
+{
+  G_TRY
+    {
+      GMonitorLock lock(&ctx->monitor);
+      if (ctx->cache)
+        return ctx->cache->get_cur_size();
+    }
+  G_CATCH(ex) 
+    { 
+      ERROR1(ctx, ex);
+    }
+  G_ENDCATCH;
+  return 0;
+}
+
 void
 ddjvu_cache_clear(ddjvu_context_t *ctx)
 {
@@ -1618,6 +1636,19 @@ ddjvu_page_s::release()
   img = 0;
 }
 
+// Waits for the decoding thread to quit, so a page created
+// again for the same file restarts decoding instead of joining
+// a decode that is about to stop.
+void
+ddjvu_page_s::stop()
+{
+  if (! img)
+    return;
+  DjVuFile *file = img->get_djvu_file();
+  if (file)
+    file->stop_decode(true);
+}
+
 ddjvu_status_t
 ddjvu_page_s::status()
 {
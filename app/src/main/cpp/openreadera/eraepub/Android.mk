@@ -2,7 +2,7 @@ LOCAL_PATH := $(call my-dir)
 include $(CLEAR_VARS)
 
 LOCAL_MODULE := eraepub
-LOCAL_STATIC_LIBRARIES := orebridge orelibjpeg orelibpng
+LOCAL_STATIC_LIBRARIES := orebridge jpeg-turbo orelibpng
 LOCAL_LDLIBS += -llog -lz
 LOCAL_CPP_FEATURES += exceptions
 
@@ -14,6 +14,7 @@ LOCAL_CFLAGS += -DCR3_ANTIWORD_PATCH=1 -DENABLE_ANTIWORD=1
 LOCAL_C_INCLUDES := \
     $(LOCAL_PATH)/../orebridge/include \
     $(LOCAL_PATH)/../ \
+    $(LOCAL_PATH)/../jpeg-turbo/jpeg-turbo/include \
     $(LOCAL_PATH)/libpng \
     $(LOCAL_PATH)/freetype/include
 
@@ -45,7 +46,9 @@ LOCAL_SRC_FILES += \
     src/lvfnt.cpp \
     src/lvfntman.cpp \
     src/lvimg.cpp \
+    src/lvlayoutcache.cpp \
     src/lvpagesplitter.cpp \
+    src/lvsearchindex.cpp \
     src/lvrend.cpp \
     src/lvstream.cpp \
     src/lvstring.cpp \
@@ -80,22 +80,6 @@ void CreBridge::responseAddString(CmdResponse& response, const lString16& str16)
     response.addData(cmd_data);
 }
 
-void CreBridge::convertBitmap(LVColorDrawBuf* bitmap)
-{
-    if (bitmap->GetBitsPerPixel() == 32) {
-        // Convert Cre colors to Android
-        int size = bitmap->GetWidth() * bitmap->GetHeight();
-        for (lUInt8* p = bitmap->GetData(); --size >= 0; p+=4) {
-            // Invert A
-            p[3] ^= 0xFF;
-            // Swap R and B
-            lUInt8 t = p[0];
-            p[0] = p[2];
-            p[2] = t;
-        }
-    }
-}
-
 void CreBridge::processOpen(CmdRequest& request, CmdResponse& response)
 {
     response.cmd = CMD_RES_OPEN;
@@ -129,7 +113,11 @@ void CreBridge::processOpen(CmdRequest& request, CmdResponse& response)
     //parseFontIndexes();
 	bool result = doc_view_->LoadDoc(doc_format, absolute_path, direct_archive);
     if (result) {
-        doc_view_->RenderIfDirty();
+        doc_view_->RenderIfDirty(doc_view_->cfg_progressive_render_);
+        if (doc_view_->IsRenderInProgress()) {
+            // Pages rendered so far, the rest is paginated on idle
+            requestIdle();
+        }
         response.addInt(ExportPagesCount(doc_view_->GetColumns(), doc_view_->GetPagesCount()));
     } else if (OreIsNormalDirectArchive(direct_archive)) {
         response.result = RES_ARCHIVE_COLLISION;
@@ -161,16 +149,64 @@ void CreBridge::processPageRender(CmdRequest& request, CmdResponse& response)
         response.result = RES_BAD_REQ_DATA;
         return;
     }
-    doc_view_->GoToPage(ImportPage(page, doc_view_->GetColumns()));
+    int doc_page = ImportPage(page, doc_view_->GetColumns());
+    if (doc_view_->IsRenderInProgress()) {
+        doc_view_->UpdateRenderedPages();
+        while (doc_page >= doc_view_->GetPagesCount()
+                && !doc_view_->ContinueRender(CRE_PROGRESSIVE_STEP_BLOCKS)) {
+            doc_view_->UpdateRenderedPages();
+        }
+    }
+    doc_view_->GoToPage(doc_page);
     auto resp = new CmdData();
-    unsigned char* pixels = resp->newByteArray(width * height * 4);
-    auto buf = new LVColorDrawBuf(width, height, pixels, 32);
+    unsigned char* pixels = newRenderPixels(resp, width * height * 4);
+    // Draw directly in Android RGBA byte order
+    auto buf = new LVColorDrawBuf(width, height, pixels, 32, true);
     doc_view_->Draw(*buf);
-    convertBitmap(buf);
     delete buf;
     response.addData(resp);
 }
 
+void CreBridge::processPagination(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_CRE_PAGINATION;
+    uint32_t finish = 0;
+    if (request.dataCount > 0) {
+        if (!CmdDataIterator(request.first).getInt(&finish).isValid()) {
+            CRLog::error("processPagination bad request data");
+            response.result = RES_BAD_REQ_DATA;
+            return;
+        }
+    }
+    if (doc_view_ == nullptr) {
+        CRLog::error("processPagination doc not opened");
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    if (finish) {
+        doc_view_->FinishRender();
+    }
+    doc_view_->UpdateRenderedPages();
+    int columns = doc_view_->GetColumns();
+    int pages = doc_view_->GetPagesCount();
+    bool done = !doc_view_->IsRenderInProgress();
+    int progress = done ? 100 : doc_view_->GetRenderProgress();
+    // Unrendered part is assumed to be as dense as rendered one
+    int estimated = (done || progress == 0) ? pages : pages * 100 / progress;
+    response.addInt(done ? 1 : 0);
+    response.addInt(ExportPagesCount(columns, pages));
+    response.addInt(ExportPagesCount(columns, estimated));
+    response.addInt((uint32_t) progress);
+}
+
+bool CreBridge::processIdle()
+{
+    if (doc_view_ == nullptr || !doc_view_->IsRenderInProgress()) {
+        return false;
+    }
+    return !doc_view_->ContinueRender(CRE_PROGRESSIVE_STEP_BLOCKS);
+}
+
 void CreBridge::processQuit(CmdRequest& request, CmdResponse& response)
 {
     doc_view_->Clear();
@@ -203,6 +239,23 @@ void CreBridge::process(CmdRequest& request, CmdResponse& response)
 {
     response.reset();
     request.print("EraEpubBridge");
+    if (doc_view_ != nullptr && doc_view_->IsRenderInProgress()) {
+        switch (request.cmd)
+        {
+            case CMD_REQ_PAGE_RENDER:
+            case CMD_REQ_RENDER_BUFFER:
+            case CMD_REQ_CRE_PAGINATION:
+            case CMD_REQ_CRE_GLYPH_CACHE:
+            case CMD_REQ_OPEN:
+            case CMD_REQ_QUIT:
+            case CMD_REQ_VERSION:
+                break;
+            default:
+                // Other requests need positions of the whole document
+                doc_view_->FinishRender();
+                break;
+        }
+    }
     switch (request.cmd)
     {
         case CMD_REQ_SET_FONT_CONFIG:
@@ -217,6 +270,12 @@ void CreBridge::process(CmdRequest& request, CmdResponse& response)
         case CMD_REQ_PAGE_RENDER:
             processPageRender(request, response);
             break;
+        case CMD_REQ_RENDER_BUFFER:
+            processRenderBuffer(request, response);
+            break;
+        case CMD_REQ_CRE_PAGINATION:
+            processPagination(request, response);
+            break;
         case CMD_REQ_LINKS:
             processPageLinks(request, response);
             break;
@@ -254,6 +313,7 @@ void CreBridge::process(CmdRequest& request, CmdResponse& response)
             OreVerResporse(OPENREADERA_BASE_VERSION, response);
             break;
         case CMD_REQ_SEARCH_PREVIEWS:
+        case CMD_REQ_SEARCH_STREAM:
             processTextSearchPreviews(request, response);
             break;
         case CMD_REQ_SEARCH_HITBOXES:
@@ -277,6 +337,9 @@ void CreBridge::process(CmdRequest& request, CmdResponse& response)
         case CMD_REQ_FONT_NAMES:
             processFontNames(request, response);
             break;
+        case CMD_REQ_CRE_GLYPH_CACHE:
+            processGlyphCache(request, response);
+            break;
         default:
             CRLog::error("Unknown request: %d", request.cmd);
             response.result = RES_UNKNOWN_CMD;
@@ -27,6 +27,9 @@
 
 typedef std::map<int, ldomWord> ldomWordMap;
 
+// Final blocks laid out per idle step of progressive pagination
+#define CRE_PROGRESSIVE_STEP_BLOCKS 200
+
 class CreBridge : public StBridge {
 private:
     LVDocView* doc_view_;
@@ -46,8 +49,6 @@ protected:
 
     void responseAddString(CmdResponse& response, const lString16& str16);
 
-    void convertBitmap(LVColorDrawBuf* bitmap);
-
     void responseAddLinkUnknown(CmdResponse& response, const lString16& href,
                                 float l, float t, float r, float b);
 
@@ -67,6 +68,10 @@ protected:
 
     void processPageRender(CmdRequest& request, CmdResponse& response);
 
+    void processPagination(CmdRequest& request, CmdResponse& response);
+
+    bool processIdle();
+
     void processPageByXPath(CmdRequest& request, CmdResponse& response);
 
     void processPageByXPathMultiple(CmdRequest& request, CmdResponse& response);
@@ -96,6 +101,8 @@ protected:
     void processImageHitbox(CmdRequest& request, CmdResponse& response);
 
     void processFontNames(CmdRequest &request, CmdResponse &response);
+
+    void processGlyphCache(CmdRequest& request, CmdResponse& response);
 };
 
 #endif //_ERAEPUB_BRIDGE_H_
@@ -271,6 +271,15 @@ void CreBridge::processConfig(CmdRequest& request, CmdResponse& response)
                 return;
             }
             gEmbeddedStylesLVL = int_val;
+        } else if (key == CONFIG_CRE_LAYOUT_CACHE_DIR) {
+            doc_view_->cfg_layout_cache_dir_ = lString8(val);
+        } else if (key == CONFIG_CRE_PROGRESSIVE_RENDER) {
+            int int_val = parseInt(val);
+            if (int_val < 0) {
+                response.result = RES_BAD_REQ_DATA;
+                return;
+            }
+            doc_view_->cfg_progressive_render_ = int_val;
         } else {
             CRLog::warn("processConfig unknown key: key=%d, val=%s", key, val);
         }
@@ -339,3 +348,32 @@ void CreBridge::processFontNames(CmdRequest &request, CmdResponse &response)
     }
     CRLog::error("processFontNames END");
 }
+
+void CreBridge::processGlyphCache(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_CRE_GLYPH_CACHE;
+    if (request.dataCount > 0) {
+        uint32_t size = 0;
+        if (!CmdDataIterator(request.first).getInt(&size).isValid()) {
+            CRLog::error("processGlyphCache bad request data");
+            response.result = RES_BAD_REQ_DATA;
+            return;
+        }
+        if (size == 0) {
+            fontMan->clearGlyphCache();
+        } else {
+            fontMan->setGlyphCacheSize((int) size);
+        }
+    }
+    LVFontGlyphCacheStats stats;
+    fontMan->getGlyphCacheStats(stats);
+    CRLog::debug("Glyph cache: hits %u misses %u evicted %u glyphs %d bytes %d of %d slabs %d",
+            stats.hits, stats.misses, stats.evictions,
+            stats.items, stats.size, stats.max_size, stats.slab_size);
+    response.addInt(stats.hits);
+    response.addInt(stats.misses);
+    response.addInt(stats.evictions);
+    response.addInt((uint32_t) stats.items);
+    response.addInt((uint32_t) stats.size);
+    response.addInt((uint32_t) stats.max_size);
+}
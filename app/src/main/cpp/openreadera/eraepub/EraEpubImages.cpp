@@ -86,10 +86,9 @@ void CreBridge::processImageByXpath(CmdRequest &request, CmdResponse &response)
             thumb_width = img->GetWidth();
             thumb_height = img->GetHeight();
             unsigned char *pixels = imgData->newByteArray(thumb_width * thumb_height * 4);
-            auto buf = new LVColorDrawBuf(thumb_width, thumb_height, pixels, 32);
+            auto buf = new LVColorDrawBuf(thumb_width, thumb_height, pixels, 32, true);
             buf->Clear(0xffffffff);
             buf->Draw(img, 0, 0, thumb_width, thumb_height, false);
-            convertBitmap(buf);
             delete buf;
             img.Clear();
         }
@@ -162,9 +162,8 @@ void CreBridge::processMeta(CmdRequest &request, CmdResponse &response) {
                 thumb_width = thumb_image->GetWidth();
                 thumb_height = thumb_image->GetHeight();
                 unsigned char *pixels = doc_thumb->newByteArray(thumb_width * thumb_height * 4);
-                auto buf = new LVColorDrawBuf(thumb_width, thumb_height, pixels, 32);
+                auto buf = new LVColorDrawBuf(thumb_width, thumb_height, pixels, 32, true);
                 buf->Draw(thumb_image, 0, 0, thumb_width, thumb_height, false);
-                convertBitmap(buf);
                 delete buf;
                 thumb_image.Clear();
             } else {
@@ -23,10 +23,16 @@
 
 void CreBridge::processTextSearchPreviews(CmdRequest &request, CmdResponse &response)
 {
-    response.cmd = CMD_RES_SEARCH_PREVIEWS;
+    bool stream = request.cmd == CMD_REQ_SEARCH_STREAM;
+    response.cmd = stream ? CMD_RES_SEARCH_STREAM : CMD_RES_SEARCH_PREVIEWS;
     CmdDataIterator iter(request.first);
     uint8_t *temp_val;
+    uint32_t batch = 0;
     iter.getByteArray(&temp_val);
+    if (stream)
+    {
+        iter.getInt(&batch);
+    }
     if (!iter.isValid())
     {
         CRLog::error("processTextSearchPreviews bad request data");
@@ -78,9 +84,44 @@ void CreBridge::processTextSearchPreviews(CmdRequest &request, CmdResponse &resp
     {
         query = lString16::processBanglaText(query);
     }
+    // Index is filled once per render, so repeated queries skip pages without query words.
+    // Streaming search does not wait for indexing, pages not indexed yet are always searched.
+    for (int p = pagestart; !stream && p <= pageend; p ++)
+    {
+        if (isCancelled())
+        {
+            response.result = RES_CANCELLED;
+            return;
+        }
+        int page = ImportPage(p, doc_view_->GetColumns());
+        doc_view_->IndexPageForSearch(page);
+        doc_view_->IndexPageForSearch(page + 1);
+    }
+    const std::vector<bool> &candidates = doc_view_->GetSearchCandidatePages(query);
+    uint32_t lastSent = 0;
     for (int p = pagestart; p <= pageend; p ++)
     {
+        if (isCancelled())
+        {
+            response.result = RES_CANCELLED;
+            return;
+        }
+        // Checked before candidate skipping, so skipped pages do not hold batches back
+        uint32_t scanned = p - pagestart;
+        if (stream && batch > 0 && scanned - lastSent >= batch)
+        {
+            sendSearchBatch(request, response, scanned, pageend - pagestart + 1, 0);
+            lastSent = scanned;
+        }
         auto page = (uint32_t) ImportPage(p, doc_view_->GetColumns());
+        if (page < candidates.size() && !candidates[page])
+        {
+            continue;
+        }
+        if (stream)
+        {
+            doc_view_->IndexPageForSearch(page);
+        }
         LVArray<SearchResult> searchPreviews = doc_view_->SearchForTextPreviews(page, query);
 
         for (int i = 0; i < searchPreviews.length(); i++)
@@ -112,6 +153,10 @@ void CreBridge::processTextSearchPreviews(CmdRequest &request, CmdResponse &resp
             responseAddString(response, lString16::restoreIndicText(text));
         }
     }
+    if (stream)
+    {
+        finishSearchStream(response, pageend - pagestart + 1, pageend - pagestart + 1, 0);
+    }
 }
 
 void CreBridge::processTextSearchHitboxes(CmdRequest &request, CmdResponse &response)
@@ -0,0 +1,51 @@
+#!/bin/sh
+#
+# Builds drawbench from eraepub/src/lvdrawbuf.cpp twice, with scalar line
+# kernels and with the kernels as shipped (SSE2 on x86, NEON on ARM), runs
+# both and checks that they draw the same page.
+#
+# Usage: build.sh [iterations]
+#   CXX       compiler, e.g. NDK aarch64-linux-android21-clang++ or
+#             armv7a-linux-androideabi21-clang++ (with CXXFLAGS=-mfpu=neon)
+#   CXXFLAGS  extra compiler flags
+#   RUN       command prefix to run the binary, e.g. qemu-aarch64 -L <sysroot>;
+#             set RUN=none to only build (then push to a device and run there)
+#   NEON_EMU  set to 1 on non ARM hosts to build the NEON kernels against
+#             neon_emu/arm_neon.h, a scalar model of the used intrinsics.
+#             It checks the NEON kernels output, its timings mean nothing.
+
+set -e
+HERE=$(cd "$(dirname "$0")" && pwd)
+EPUB="$HERE/.."
+OUT="${OUT:-$HERE/out}"
+CXX="${CXX:-c++}"
+FLAGS="-std=c++14 -O2 -DHAVE_CONFIG_H -DLINUX=1 -D_LINUX=1 -I$EPUB -I$EPUB/include -include cstdint $CXXFLAGS"
+SCALAR_FLAGS="-U__SSE2__ -U__ARM_NEON -U__ARM_NEON__"
+if [ "$NEON_EMU" = "1" ]; then
+    SIMD_FLAGS="-U__SSE2__ -D__ARM_NEON -I$HERE/neon_emu"
+    OUT="$OUT-neon-emu"
+fi
+
+mkdir -p "$OUT"
+$CXX $FLAGS $SCALAR_FLAGS -c "$EPUB/src/lvdrawbuf.cpp" -o "$OUT/lvdrawbuf-scalar.o"
+$CXX $FLAGS $SCALAR_FLAGS -c "$HERE/drawbench.cpp" -o "$OUT/drawbench-scalar.o"
+$CXX -o "$OUT/drawbench-scalar" "$OUT/drawbench-scalar.o" "$OUT/lvdrawbuf-scalar.o"
+$CXX $FLAGS $SIMD_FLAGS -c "$EPUB/src/lvdrawbuf.cpp" -o "$OUT/lvdrawbuf.o"
+$CXX $FLAGS $SIMD_FLAGS -c "$HERE/drawbench.cpp" -o "$OUT/drawbench.o"
+$CXX -o "$OUT/drawbench" "$OUT/drawbench.o" "$OUT/lvdrawbuf.o"
+
+if [ "$RUN" != "none" ]; then
+    status=0
+    $RUN "$OUT/drawbench-scalar" "$@" > "$OUT/scalar.txt" || status=1
+    $RUN "$OUT/drawbench" "$@" > "$OUT/simd.txt" || status=1
+    cat "$OUT/scalar.txt" "$OUT/simd.txt"
+    # page size and checksum columns
+    for f in scalar simd; do
+        grep -E '^[0-9]+x[0-9]+ ' "$OUT/$f.txt" | awk '{ print $1, $NF }' > "$OUT/$f.sum"
+    done
+    if ! cmp -s "$OUT/scalar.sum" "$OUT/simd.sum"; then
+        echo "line kernels draw other pixels than scalar build"
+        status=1
+    fi
+    exit $status
+fi
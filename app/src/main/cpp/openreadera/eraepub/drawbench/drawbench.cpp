@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+// Times page drawing into LVColorDrawBuf on a dense synthetic text page:
+// the old path (draw in CR format, then CreBridge::convertBitmap pass) against
+// direct drawing in client RGBA byte order. Both outputs must be byte identical.
+// The checksum of the page lets build.sh compare the line kernels (SSE2/NEON)
+// with a scalar build. Build and run with build.sh, exit code is 1 on any mismatch.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "include/lvdrawbuf.h"
+
+// same selection as the line kernels in lvdrawbuf.cpp
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define KERNELS "neon"
+#elif defined(__SSE2__)
+#define KERNELS "sse2"
+#else
+#define KERNELS "scalar"
+#endif
+
+// lvdrawbuf.cpp is linked alone, these are the only symbols it needs from the rest of eraepub
+ref_count_rec_t ref_count_rec_t::null_ref(NULL);
+
+void crFatalError( int code, const char * errorText )
+{
+    fprintf(stderr, "fatal error %d: %s\n", code, errorText);
+    exit(2);
+}
+
+void CRLog::error( const char * msg, ... )
+{
+    (void)msg;
+}
+
+LVImageDecoderCallback::~LVImageDecoderCallback() {}
+
+CR9PatchInfo * LVImageSource::DetectNinePatch()
+{
+    return NULL;
+}
+
+LVImageSource::~LVImageSource() {}
+
+LVImageSourceRef LVImageSource::GetReducedSource( int, int )
+{
+    return LVImageSourceRef();
+}
+
+#define GLYPH_COUNT 64
+#define GLYPH_DX 16
+#define GLYPH_DY 22
+#define LINE_DY 30
+#define MARGIN 40
+
+static lUInt32 rnd_state = 2463534242u;
+
+static lUInt32 rnd()
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+/// antialiased 8bpp glyph coverage, a few strokes per glyph like rasterized by lvfntman
+static void makeGlyph( lUInt8 * bmp )
+{
+    memset(bmp, 0, GLYPH_DX * GLYPH_DY);
+    int strokes = 2 + rnd() % 3;
+    for (int i = 0; i < strokes; i++) {
+        float x0 = 2 + rnd() % (GLYPH_DX - 4), y0 = 3 + rnd() % (GLYPH_DY - 6);
+        float x1 = 2 + rnd() % (GLYPH_DX - 4), y1 = 3 + rnd() % (GLYPH_DY - 6);
+        float dx = x1 - x0, dy = y1 - y0;
+        float len2 = dx * dx + dy * dy + 0.01f;
+        for (int y = 0; y < GLYPH_DY; y++)
+            for (int x = 0; x < GLYPH_DX; x++) {
+                float t = ((x - x0) * dx + (y - y0) * dy) / len2;
+                t = t < 0 ? 0 : (t > 1 ? 1 : t);
+                float ex = x - (x0 + t * dx), ey = y - (y0 + t * dy);
+                float d = ex * ex + ey * ey;
+                // 1.5px wide stroke with 1px antialiased edge
+                int c = d < 0.6f ? 255 : (d < 2.2f ? (int)((2.2f - d) * 160) : 0);
+                lUInt8 & p = bmp[y * GLYPH_DX + x];
+                if (c > p)
+                    p = (lUInt8)c;
+            }
+    }
+}
+
+/// decoded picture with rounded transparent corners and antialiased edge,
+/// lines are decoded up front so only drawing is timed
+class BenchImage : public LVImageSource
+{
+    int _dx;
+    int _dy;
+    std::vector<lUInt32> _pixels;
+public:
+    BenchImage( int dx, int dy ) : _dx(dx), _dy(dy), _pixels(dx * dy)
+    {
+        int r = dy / 8;
+        for (int y = 0; y < dy; y++)
+            for (int x = 0; x < dx; x++) {
+                int cx = x < r ? r - x : (x >= dx - r ? x - (dx - r - 1) : 0);
+                int cy = y < r ? r - y : (y >= dy - r ? y - (dy - r - 1) : 0);
+                int d = cx * cx + cy * cy - r * r;
+                lUInt32 alpha = d > r ? 0xFF : (d > -r ? 0x80 : 0);
+                _pixels[y * dx + x] = (alpha << 24) | ((x * 255 / dx) << 16) | ((y * 255 / dy) << 8) | 0x60;
+            }
+    }
+    virtual ldomNode * GetSourceNode() { return NULL; }
+    virtual LVStream * GetSourceStream() { return NULL; }
+    virtual void Compact() {}
+    virtual int GetWidth() { return _dx; }
+    virtual int GetHeight() { return _dy; }
+    virtual bool Decode( LVImageDecoderCallback * callback )
+    {
+        callback->OnStartDecode(this);
+        for (int y = 0; y < _dy; y++)
+            callback->OnLineDecoded(this, y, &_pixels[y * _dx]);
+        callback->OnEndDecode(this, false);
+        return true;
+    }
+};
+
+static lUInt8 glyphs[GLYPH_COUNT][GLYPH_DX * GLYPH_DY];
+
+/// background, text lines, a highlight, underlines and a picture,
+/// drawn with the same calls LVDocView uses for an EPUB page
+static void drawPage( LVColorDrawBuf & buf, LVImageSourceRef & img )
+{
+    int dx = buf.GetWidth();
+    int dy = buf.GetHeight();
+    buf.Clear(0xF4ECD8);
+    buf.SetTextColor(0x202020);
+    lUInt32 seed = 12345;
+    int imgTop = dy / 3;
+    int imgBottom = imgTop + img->GetHeight();
+    for (int y = MARGIN, line = 0; y + GLYPH_DY < dy - MARGIN; y += LINE_DY, line++) {
+        if (y + LINE_DY > imgTop && y < imgBottom)
+            continue;
+        if (line % 7 == 3)
+            buf.FillRect(MARGIN, y, dx - MARGIN, y + LINE_DY, 0x80FFE070);
+        for (int x = MARGIN; x + GLYPH_DX < dx - MARGIN; x += GLYPH_DX - 4) {
+            seed = seed * 1103515245 + 12345;
+            int g = (seed >> 16) % (GLYPH_COUNT + 8);
+            if (g >= GLYPH_COUNT) {
+                x += 4; // word space
+                continue;
+            }
+            buf.Draw(x, y, glyphs[g], GLYPH_DX, GLYPH_DY, NULL);
+        }
+        if (line % 11 == 5)
+            buf.FillRect(MARGIN, y + GLYPH_DY, dx / 2, y + GLYPH_DY + 2, 0x2040A0);
+    }
+    buf.Draw(img, (dx - img->GetWidth()) / 2, imgTop, img->GetWidth(), img->GetHeight(), false);
+}
+
+/// CreBridge::convertBitmap as it was before direct RGBA drawing
+static void convertBitmap( LVColorDrawBuf * bitmap )
+{
+    if (bitmap->GetBitsPerPixel() == 32) {
+        // Convert Cre colors to Android
+        int size = bitmap->GetWidth() * bitmap->GetHeight();
+        for (lUInt8* p = bitmap->GetData(); --size >= 0; p+=4) {
+            // Invert A
+            p[3] ^= 0xFF;
+            // Swap R and B
+            lUInt8 t = p[0];
+            p[0] = p[2];
+            p[2] = t;
+        }
+    }
+}
+
+/// FNV-1a over page bytes
+static lUInt32 checksum( const std::vector<lUInt8> & pixels )
+{
+    lUInt32 h = 2166136261u;
+    for (size_t i = 0; i < pixels.size(); i++)
+        h = (h ^ pixels[i]) * 16777619u;
+    return h;
+}
+
+static double nowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+int main( int argc, char ** argv )
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+    if (iterations <= 0)
+        iterations = 1;
+    static const int sizes[][2] = { { 720, 1280 }, { 1080, 1920 }, { 1600, 2560 } };
+    for (int i = 0; i < GLYPH_COUNT; i++)
+        makeGlyph(glyphs[i]);
+
+    int errors = 0;
+    printf("line kernels: %s\n", KERNELS);
+    printf("%-10s %12s %12s %8s %10s\n", "page", "convert ms", "rgba ms", "speedup", "checksum");
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int dx = sizes[s][0];
+        int dy = sizes[s][1];
+        LVImageSourceRef img(new BenchImage(dx / 2, dy / 5));
+        std::vector<lUInt8> oldPixels(dx * dy * 4);
+        std::vector<lUInt8> newPixels(dx * dy * 4);
+        LVColorDrawBuf oldBuf(dx, dy, &oldPixels[0], 32);
+        LVColorDrawBuf newBuf(dx, dy, &newPixels[0], 32, true);
+        // best of iterations, first run warms caches
+        double oldMs = 1e9, newMs = 1e9;
+        for (int i = 0; i < iterations; i++) {
+            double t0 = nowMs();
+            drawPage(oldBuf, img);
+            convertBitmap(&oldBuf);
+            double t1 = nowMs();
+            drawPage(newBuf, img);
+            double t2 = nowMs();
+            if (t1 - t0 < oldMs)
+                oldMs = t1 - t0;
+            if (t2 - t1 < newMs)
+                newMs = t2 - t1;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", dx, dy);
+        printf("%-10s %12.3f %12.3f %7.2fx %10x\n", name, oldMs, newMs, oldMs / newMs, checksum(newPixels));
+        if (memcmp(&oldPixels[0], &newPixels[0], oldPixels.size())) {
+            printf("%s: RGBA output differs from draw-then-convert output\n", name);
+            errors++;
+        }
+    }
+    return errors ? 1 : 0;
+}
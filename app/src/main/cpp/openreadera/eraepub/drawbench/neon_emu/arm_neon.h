@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+// Scalar model of the NEON intrinsics used by the lvdrawbuf.cpp line kernels,
+// lane by lane as the ARM reference describes them. Lets build.sh compile and
+// check the NEON kernels on hosts without an ARM toolchain (NEON_EMU=1).
+// Timings of such a build mean nothing, only its output does.
+
+#ifndef __DRAWBENCH_ARM_NEON_H__
+#define __DRAWBENCH_ARM_NEON_H__
+
+#include <cstdint>
+#include <cstring>
+
+template<typename T, int N>
+struct neon_emu_vec
+{
+    T v[N];
+};
+
+typedef neon_emu_vec<uint8_t, 8> uint8x8_t;
+typedef neon_emu_vec<uint8_t, 16> uint8x16_t;
+typedef neon_emu_vec<uint16_t, 8> uint16x8_t;
+typedef neon_emu_vec<uint32_t, 2> uint32x2_t;
+typedef neon_emu_vec<uint32_t, 4> uint32x4_t;
+
+template<typename T, int N>
+static inline neon_emu_vec<T, N / 2> neon_emu_half(const neon_emu_vec<T, N>& a, int from)
+{
+    neon_emu_vec<T, N / 2> r;
+    for (int i = 0; i < N / 2; i++) r.v[i] = a.v[from + i];
+    return r;
+}
+
+// Same bits seen as other lane type, little endian like Android ARM targets
+template<typename R, typename A>
+static inline R neon_emu_cast(const A& a)
+{
+    R r;
+    memcpy(&r, &a, sizeof(r));
+    return r;
+}
+
+static inline uint8x8_t vget_low_u8(uint8x16_t a) { return neon_emu_half(a, 0); }
+static inline uint8x8_t vget_high_u8(uint8x16_t a) { return neon_emu_half(a, 8); }
+static inline uint32x2_t vget_low_u32(uint32x4_t a) { return neon_emu_half(a, 0); }
+static inline uint32x2_t vget_high_u32(uint32x4_t a) { return neon_emu_half(a, 2); }
+static inline uint32_t vget_lane_u32(uint32x2_t a, int lane) { return a.v[lane]; }
+static inline uint8x16_t vcombine_u8(uint8x8_t a, uint8x8_t b)
+{
+    uint8x16_t r;
+    for (int i = 0; i < 8; i++) { r.v[i] = a.v[i]; r.v[8 + i] = b.v[i]; }
+    return r;
+}
+
+static inline uint8x8_t vreinterpret_u8_u32(uint32x2_t a) { return neon_emu_cast<uint8x8_t>(a); }
+static inline uint8x16_t vreinterpretq_u8_u32(uint32x4_t a) { return neon_emu_cast<uint8x16_t>(a); }
+
+static inline uint8x8_t vdup_n_u8(uint8_t x) { uint8x8_t r; for (int i = 0; i < 8; i++) r.v[i] = x; return r; }
+static inline uint8x16_t vdupq_n_u8(uint8_t x) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = x; return r; }
+static inline uint32x2_t vdup_n_u32(uint32_t x) { uint32x2_t r; for (int i = 0; i < 2; i++) r.v[i] = x; return r; }
+static inline uint32x4_t vdupq_n_u32(uint32_t x) { uint32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = x; return r; }
+
+static inline uint8x8_t vld1_u8(const uint8_t* p) { uint8x8_t r; memcpy(r.v, p, 8); return r; }
+static inline uint8x16_t vld1q_u8(const uint8_t* p) { uint8x16_t r; memcpy(r.v, p, 16); return r; }
+static inline uint32x4_t vld1q_u32(const uint32_t* p) { uint32x4_t r; memcpy(r.v, p, 16); return r; }
+static inline void vst1q_u8(uint8_t* p, uint8x16_t a) { memcpy(p, a.v, 16); }
+static inline void vst1q_u32(uint32_t* p, uint32x4_t a) { memcpy(p, a.v, 16); }
+
+static inline uint8x16_t vandq_u8(uint8x16_t a, uint8x16_t b) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = a.v[i] & b.v[i]; return r; }
+static inline uint8x16_t vorrq_u8(uint8x16_t a, uint8x16_t b) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = a.v[i] | b.v[i]; return r; }
+static inline uint32x4_t vandq_u32(uint32x4_t a, uint32x4_t b) { uint32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] & b.v[i]; return r; }
+static inline uint32x4_t vorrq_u32(uint32x4_t a, uint32x4_t b) { uint32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] | b.v[i]; return r; }
+static inline uint32x4_t vbicq_u32(uint32x4_t a, uint32x4_t b) { uint32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] & ~b.v[i]; return r; }
+static inline uint8x16_t vbslq_u8(uint8x16_t m, uint8x16_t a, uint8x16_t b)
+{
+    uint8x16_t r;
+    for (int i = 0; i < 16; i++) r.v[i] = (m.v[i] & a.v[i]) | (~m.v[i] & b.v[i]);
+    return r;
+}
+
+static inline uint8x16_t vsubq_u8(uint8x16_t a, uint8x16_t b) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = (uint8_t)(a.v[i] - b.v[i]); return r; }
+static inline uint8x16_t vcgtq_u8(uint8x16_t a, uint8x16_t b) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = a.v[i] > b.v[i] ? 0xFF : 0; return r; }
+static inline uint8x16_t vceqq_u8(uint8x16_t a, uint8x16_t b) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = a.v[i] == b.v[i] ? 0xFF : 0; return r; }
+
+static inline uint8x16_t vshrq_n_u8(uint8x16_t a, int n) { uint8x16_t r; for (int i = 0; i < 16; i++) r.v[i] = a.v[i] >> n; return r; }
+static inline uint32x4_t vshrq_n_u32(uint32x4_t a, int n) { uint32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] >> n; return r; }
+static inline uint32x4_t vshlq_n_u32(uint32x4_t a, int n) { uint32x4_t r; for (int i = 0; i < 4; i++) r.v[i] = a.v[i] << n; return r; }
+static inline uint8x8_t vshrn_n_u16(uint16x8_t a, int n) { uint8x8_t r; for (int i = 0; i < 8; i++) r.v[i] = (uint8_t)(a.v[i] >> n); return r; }
+
+static inline uint16x8_t vmull_u8(uint8x8_t a, uint8x8_t b) { uint16x8_t r; for (int i = 0; i < 8; i++) r.v[i] = (uint16_t)(a.v[i] * b.v[i]); return r; }
+static inline uint16x8_t vmlal_u8(uint16x8_t acc, uint8x8_t a, uint8x8_t b)
+{
+    uint16x8_t r;
+    for (int i = 0; i < 8; i++) r.v[i] = (uint16_t)(acc.v[i] + a.v[i] * b.v[i]);
+    return r;
+}
+
+static inline uint8x8_t vtbl1_u8(uint8x8_t t, uint8x8_t idx)
+{
+    uint8x8_t r;
+    for (int i = 0; i < 8; i++) r.v[i] = idx.v[i] < 8 ? t.v[idx.v[i]] : 0;
+    return r;
+}
+
+static inline uint32x2_t vpmin_u32(uint32x2_t a, uint32x2_t b)
+{
+    uint32x2_t r;
+    r.v[0] = a.v[0] < a.v[1] ? a.v[0] : a.v[1];
+    r.v[1] = b.v[0] < b.v[1] ? b.v[0] : b.v[1];
+    return r;
+}
+
+static inline uint32x2_t vpmax_u32(uint32x2_t a, uint32x2_t b)
+{
+    uint32x2_t r;
+    r.v[0] = a.v[0] > a.v[1] ? a.v[0] : a.v[1];
+    r.v[1] = b.v[0] > b.v[1] ? b.v[0] : b.v[1];
+    return r;
+}
+
+#endif
@@ -17,6 +17,7 @@
 #include "lvptrvec.h"
 #include "bookmark.h"
 #include "crconfig.h"
+#include "lvsearchindex.h"
 
 // Yep, twice include single header with different define. Probably should be last in include list,
 // to don't mess up with other includes.
@@ -26,7 +27,6 @@
 //#undef XS_IMPLEMENT_SCHEME
 
 typedef std::map<int, ldomWord> ldomWordMap;
-typedef std::map<std::string, int> lString16Map;
 /// document view mode: pages/scroll
 enum LVDocViewMode
 {
@@ -278,6 +278,7 @@ private:
     LVImageSourceRef background_image;
     LVRef<LVColorDrawBuf> background_image_scaled_;
     LVRendPageList pages_list_;
+    LVSearchIndex search_index_;
     lvRect page_rects_[2];
     CRPropRef doc_props_;
     ldomMarkedRangeList marked_ranges_;
@@ -326,6 +327,8 @@ public:
     bool cfg_enable_footnotes_;
     bool cfg_firstpage_thumb_;
     bool cfg_txt_smart_format_;
+    lString8 cfg_layout_cache_dir_;
+    int cfg_progressive_render_;
     PageHitboxesCash hitboxesCash;
 
     inline bool IsPagesMode() { return viewport_mode_ == MODE_PAGES; }
@@ -337,8 +340,19 @@ public:
     ldomMarkedRangeList* getMarkedRanges() { return &marked_ranges_; }
     /// returns XPointer to middle paragraph of current page
     ldomXPointer getCurrentPageMiddleParagraph();
-    /// render document, if not rendered
-    void RenderIfDirty();
+    /// render document, if not rendered,
+    /// with firstBlocks>0 renders that many final blocks and paginates rest by ContinueRender
+    void RenderIfDirty(int firstBlocks = 0);
+    /// returns true if document is paginated partially, pages list has rendered pages only
+    bool IsRenderInProgress();
+    /// renders next maxBlocks final blocks, rest of document if 0, returns true when render is done
+    bool ContinueRender(int maxBlocks);
+    /// renders rest of document
+    void FinishRender() { ContinueRender(0); }
+    /// refills pages list with pages rendered so far
+    void UpdateRenderedPages();
+    /// returns rendered percent of document
+    int GetRenderProgress();
     /// sets new list of bookmarks, removes old values
     void SetBookmarks(LVPtrVector<CRBookmark>& bookmarks);
     /// find bookmark by window point, return NULL if point doesn't belong to any bookmark
@@ -492,6 +506,10 @@ public:
 
     lString16Map GetWordsIndexesMap();
     lString16Map GetPhrasesIndexesMapForPage(int page_index);
+    /// Adds page text to the search index, does nothing if page is already indexed
+    void IndexPageForSearch(int page_index);
+    /// Pages where match of query may start, see LVSearchIndex::FindCandidatePages
+    const std::vector<bool> &GetSearchCandidatePages(lString16 query);
 
     LVArray<Hitbox> unionRects(LVArray<Hitbox> rects);
 
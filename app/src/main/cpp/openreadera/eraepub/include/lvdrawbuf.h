@@ -91,6 +91,8 @@ public:
     virtual int  GetHeight() = 0;
     /// get buffer bits per pixel
     virtual int  GetBitsPerPixel() = 0;
+    /// returns true if 32bpp pixels are stored in client RGBA byte order
+    virtual bool IsRGBA() { return false; }
     /// fills buffer with specified color
     virtual int  GetRowSize() = 0;
     /// fills buffer with specified color
@@ -329,6 +331,7 @@ private:
 #endif
     int _bpp;
     bool _ownData;
+    bool _rgba;
 public:
     /// returns white pixel value
     virtual lUInt32 GetWhiteColor();
@@ -348,6 +351,8 @@ public:
     virtual void  Invert();
     /// get buffer bits per pixel
     virtual int  GetBitsPerPixel();
+    /// returns true if 32bpp pixels are stored in client RGBA byte order
+    virtual bool IsRGBA() { return _rgba; }
     /// fills buffer with specified color
     virtual void Clear( lUInt32 color );
     /// get pixel value
@@ -369,8 +374,9 @@ public:
 
     /// create own draw buffer
     LVColorDrawBuf(int dx, int dy, int bpp=32);
-    /// creates wrapper around external RGBA buffer
-    LVColorDrawBuf(int dx, int dy, lUInt8 * externalBuffer, int bpp=32 );
+    /// creates wrapper around external buffer; with rgba=true 32bpp pixels are
+    /// written as R,G,B,A bytes (A=0xFF opaque), ready to be passed to client as is
+    LVColorDrawBuf(int dx, int dy, lUInt8 * externalBuffer, int bpp=32, bool rgba=false );
     /// destructor
     virtual ~LVColorDrawBuf();
     /// convert to 1-bit bitmap
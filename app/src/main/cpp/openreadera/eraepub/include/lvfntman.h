@@ -27,6 +27,24 @@ class LVDrawBuf;
 
 struct LVFontGlyphCacheItem;
 
+/// glyph cache statistics
+struct LVFontGlyphCacheStats
+{
+    lUInt32 hits;
+    lUInt32 misses;
+    lUInt32 evictions;
+    int items;
+    int size;
+    int max_size;
+    int slab_size;
+};
+
+/// glyph items are carved from slabs of this size and recycled by size class
+#define GLYPH_CACHE_SLAB_SIZE 0x10000
+/// size classes are 32 << index bytes, bigger items are allocated separately
+#define GLYPH_CACHE_SIZE_CLASSES 11
+
+/// LRU of glyph items of all fonts, limited by total size in bytes
 class LVFontGlobalGlyphCache
 {
 private:
@@ -34,38 +52,63 @@ private:
     LVFontGlyphCacheItem * tail;
     int size;
     int max_size;
+    int items;
+    lUInt32 hits;
+    lUInt32 misses;
+    lUInt32 evictions;
+    void * free_blocks[GLYPH_CACHE_SIZE_CLASSES];
+    LVArray<lUInt8 *> slabs;
+    lUInt8 * slab_pos;
+    int slab_left;
     void removeNoLock( LVFontGlyphCacheItem * item );
     void putNoLock( LVFontGlyphCacheItem * item );
+    void releaseSlabs();
 public:
     LVFontGlobalGlyphCache( int maxSize )
-        : head(NULL), tail(NULL), size(0), max_size(maxSize )
+        : head(NULL), tail(NULL), size(0), max_size(maxSize), items(0)
+        , hits(0), misses(0), evictions(0), slab_pos(NULL), slab_left(0)
     {
+        memset( free_blocks, 0, sizeof(free_blocks) );
     }
     ~LVFontGlobalGlyphCache()
     {
         clear();
+        releaseSlabs();
     }
+    /// returns size class of item of specified size, -1 for items allocated separately
+    static int sizeClass( int sz );
+    /// returns memory taken by item of specified size
+    static int blockSize( int sz );
+    void * allocBlock( int sz );
+    void freeBlock( void * block, int sz );
     void put( LVFontGlyphCacheItem * item );
     void remove( LVFontGlyphCacheItem * item );
     void refresh( LVFontGlyphCacheItem * item );
+    void onLookup( bool hit ) { if ( hit ) hits++; else misses++; }
     void clear();
+    /// sets cache size in bytes, evicts least recently used glyphs if necessary
+    void setMaxSize( int maxSize );
+    void getStats( LVFontGlyphCacheStats & stats );
 };
 
+/// glyph items of single font, ch is used as index of two level table
 class LVFontLocalGlyphCache
 {
 private:
-    LVFontGlyphCacheItem * head;
-    LVFontGlyphCacheItem * tail;
+    LVFontGlyphCacheItem ** pages[256];
     LVFontGlobalGlyphCache * global_cache;
     int size;
 public:
     LVFontLocalGlyphCache( LVFontGlobalGlyphCache * globalCache )
-        : head(NULL), tail(NULL), global_cache( globalCache )
-    { }
+        : global_cache( globalCache ), size(0)
+    {
+        memset( pages, 0, sizeof(pages) );
+    }
     ~LVFontLocalGlyphCache()
     {
         clear();
     }
+    LVFontGlobalGlyphCache * getGlobalCache() { return global_cache; }
     void clear();
     LVFontGlyphCacheItem * get( lUInt16 ch );
     void put( LVFontGlyphCacheItem * item );
@@ -76,15 +119,13 @@ struct LVFontGlyphCacheItem
 {
     LVFontGlyphCacheItem * prev_global;
     LVFontGlyphCacheItem * next_global;
-    LVFontGlyphCacheItem * prev_local;
-    LVFontGlyphCacheItem * next_local;
     LVFontLocalGlyphCache * local_cache;
     lChar16 ch;
-    lUInt8 bmp_width;
-    lUInt8 bmp_height;
-    lInt8  origin_x;
-    lInt8  origin_y;
-    lUInt8 advance;
+    lUInt16 bmp_width;
+    lUInt16 bmp_height;
+    lInt16  origin_x;
+    lInt16  origin_y;
+    lUInt16 advance;
     lUInt8 bmp[1];
 
     int getSize()
@@ -94,24 +135,22 @@ struct LVFontGlyphCacheItem
     }
     static LVFontGlyphCacheItem * newItem( LVFontLocalGlyphCache * local_cache, lChar16 ch, int w, int h )
     {
-        LVFontGlyphCacheItem * item = (LVFontGlyphCacheItem *)malloc( sizeof(LVFontGlyphCacheItem)
-            + (w*h - 1)*sizeof(lUInt8) );
+        LVFontGlyphCacheItem * item = (LVFontGlyphCacheItem *)local_cache->getGlobalCache()->allocBlock(
+            sizeof(LVFontGlyphCacheItem) + (w*h - 1)*sizeof(lUInt8) );
         item->ch = ch;
-        item->bmp_width = (lUInt8)w;
-        item->bmp_height = (lUInt8)h;
+        item->bmp_width = (lUInt16)w;
+        item->bmp_height = (lUInt16)h;
         item->origin_x =   0;
         item->origin_y =   0;
         item->advance =    0;
         item->prev_global = NULL;
         item->next_global = NULL;
-        item->prev_local = NULL;
-        item->next_local = NULL;
         item->local_cache = local_cache;
         return item;
     }
     static void freeItem( LVFontGlyphCacheItem * item )
     {
-        free( item );
+        item->local_cache->getGlobalCache()->freeBlock( item, item->getSize() );
     }
 };
 
@@ -349,6 +388,10 @@ public:
     virtual lUInt32 GetFontListHash(int /*documentId*/) { return 0; }
     /// clear glyph cache
     virtual void clearGlyphCache() { }
+    /// sets glyph cache size in bytes
+    virtual void setGlyphCacheSize( int /*size*/ ) { }
+    /// returns glyph cache statistics
+    virtual void getGlyphCacheStats( LVFontGlyphCacheStats & stats ) { memset( &stats, 0, sizeof(stats) ); }
 
     /// get antialiasing mode
     virtual int GetAntialiasMode() { return _antialiasMode; }
@@ -16,9 +16,12 @@
 
 #include "lvref.h"
 #include "lvstream.h"
+#include "lvptrvec.h"
 
 // Max unpacked size of skin image to hold in cache unpacked
 #define MAX_SKIN_IMAGE_CACHE_ITEM_UNPACKED_SIZE 80*80*4
+// Total unpacked size of document images scaled to drawing size to hold in cache
+#define SCALED_IMAGE_CACHE_SIZE 0x1000000
 
 class LVImageSource;
 class ldomNode;
@@ -59,6 +62,9 @@ public:
     virtual int    GetWidth() = 0;
     virtual int    GetHeight() = 0;
     virtual bool   Decode( LVImageDecoderCallback * callback ) = 0;
+    /// returns source decoding the same image at reduced size, not less than dx x dy,
+    /// faster than full size one; null ref if decoder can't do it
+    virtual LVRef<LVImageSource> GetReducedSource( int dx, int dy );
     LVImageSource() : _ninePatch(NULL) {}
     virtual ~LVImageSource();
 };
@@ -103,6 +109,31 @@ LVImageSourceRef LVCreateUnpackedImageSource(LVImageSourceRef srcImage, int maxS
 /// creates image source based on draw buffer
 LVImageSourceRef LVCreateDrawBufImageSource(LVColorDrawBuf* buf, bool own);
 
+/// cache of images decoded at drawing size, limited by total unpacked size
+class LVScaledImageCache
+{
+    struct Item {
+        lString16 name;
+        int dx;
+        int dy;
+        int size;
+        int lastAccess;
+        LVImageSourceRef img;
+    };
+    LVPtrVector<Item> _items;
+    int _size;
+    int _maxSize;
+    int _accessCounter;
+public:
+    LVScaledImageCache( int maxSize ) : _size(0), _maxSize(maxSize), _accessCounter(0) { }
+    /// returns cached image decoded at dx x dy, or null ref
+    LVImageSourceRef get( const lString16 & name, int dx, int dy );
+    /// decodes src at dx x dy and puts it into cache, returns src itself if it's too big to cache
+    LVImageSourceRef put( const lString16 & name, LVImageSourceRef src, int dx, int dy );
+    /// drops all cached images
+    void clear();
+};
+
 #define COLOR_TRANSFORM_BRIGHTNESS_NONE 0x808080
 #define COLOR_TRANSFORM_CONTRAST_NONE 0x404040
 
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#ifndef _OPENREADERA_LVLAYOUTCACHE_H_
+#define _OPENREADERA_LVLAYOUTCACHE_H_
+
+#include "include/lvtinydom.h"
+
+/// Layout cache keeps render rects of elements and page list of formatted document,
+/// so reopening document with the same settings skips formatting
+#define LAYOUT_CACHE_MAGIC   "CRLAYOUT"
+#define LAYOUT_CACHE_VERSION 1
+
+/// Returns layout cache file path for document stream, key is built from stream size and content samples
+lString8 LayoutCacheFileName(const lString8& dir, LVStreamRef stream, int doc_format);
+
+#endif //_OPENREADERA_LVLAYOUTCACHE_H_
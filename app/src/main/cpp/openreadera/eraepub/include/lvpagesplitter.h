@@ -353,7 +353,7 @@ class LVRendPageContext
         return ref.get();
     }
 
-    void split();
+    void split(LVRendPageList* pages, bool partial);
 public:
 
 
@@ -363,6 +363,12 @@ public:
     }
     bool updateRenderProgress( int numFinalBlocksRendered );
 
+    /// returns number of final blocks rendered so far
+    int getRenderedFinalBlocks() { return renderedFinalBlocks; }
+
+    /// returns number of final blocks set by setCallback
+    int getTotalFinalBlocks() { return totalFinalBlocks; }
+
     /// append footnote link to last added line
     void addLink( lString16 id );
 
@@ -383,7 +389,14 @@ public:
     /// add source line
     void AddLine( int starty, int endy, int flags );
 
-    void Finalize();
+    /// splits lines to pages, keepLines allows to split them again later
+    void Finalize(bool keepLines = false);
+
+    /// splits lines added so far to pages, keeps lines to continue render
+    void SplitPartial(LVRendPageList* pages);
+
+    /// splits lines kept by Finalize to pages of new height
+    void Resplit(LVRendPageList* pages, int pageHeight);
 };
 
 #endif
@@ -36,6 +36,42 @@ void renderFinalBlock(
         int line_h);
 /// renders block which contains subblocks
 int renderBlockElement(LVRendPageContext & context, ldomNode * node, int x, int y, int width );
+/// renders block elements tree in steps, same layout as renderBlockElement
+class LVProgressiveRender
+{
+    struct Frame
+    {
+        ldomNode* node;
+        bool footnote;
+        int em;
+        int margin_top;
+        int margin_bottom;
+        int padding_left;
+        int padding_bottom;
+        int inner_width;
+        int y;
+        int child;
+        int count;
+    };
+    LVRendPageContext& context_;
+    LVArray<Frame> stack_;
+    ldomNode* root_;
+    int x_;
+    int y_;
+    int width_;
+    int height_;
+    bool done_;
+    void push(ldomNode* node, int x, int y, int width);
+    /// finishes top block, returns its height including margins
+    int pop();
+public:
+    LVProgressiveRender(LVRendPageContext& context, ldomNode* root, int x, int y, int width);
+    /// renders at least maxFinalBlocks final blocks, returns true when whole tree is rendered
+    bool Step(int maxFinalBlocks);
+    bool IsDone() { return done_; }
+    /// returns height of root block, height of rendered part until done
+    int GetHeight() { return height_; }
+};
 /// renders table element
 int renderTable(LVRendPageContext & context, ldomNode * element, int x, int y, int width );
 /// sets node style
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#ifndef _OPENREADERA_LVSEARCHINDEX_H_
+#define _OPENREADERA_LVSEARCHINDEX_H_
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/lvarray.h"
+#include "include/lvstring.h"
+
+typedef std::map<std::string, int> lString16Map;
+
+/// Occurrence of indexed term: page and word number on the page
+class LVSearchPosting
+{
+public:
+    int page;
+    int offset;
+};
+
+/**
+ * Inverted index of rendered document pages text: term -> postings, plus per page
+ * phrase (2- and 3-gram) counters used by search suggestions.
+ * Page numbers depend on pagination, so index has to be reset on every render.
+ */
+class LVSearchIndex
+{
+private:
+    std::vector<bool> indexed_;
+    std::vector<lString16Map> phrases_;
+    /// Last and first word of every page, to find words split between pages
+    std::vector<std::string> first_terms_;
+    std::vector<std::string> last_terms_;
+    std::unordered_map<std::string, std::vector<LVSearchPosting>> terms_;
+    int indexed_count_ = 0;
+
+    std::string cached_query_;
+    std::vector<bool> cached_pages_;
+
+    static void AddPhrase(lString16Map &map, const std::string &phrase);
+
+public:
+    /// Splits lowercased text into words and single punctuation characters
+    static void Tokenize(const lString16 &text, LVArray<lString16> &tokens);
+    static bool IsPunctuation(const lString16 &token);
+
+    void Reset(int pages_count);
+    int GetPagesCount() const { return (int) indexed_.size(); }
+    bool IsIndexed(int page) const;
+    bool IsComplete() const { return indexed_count_ == (int) indexed_.size(); }
+    void AddPage(int page, const lString16 &text);
+    const lString16Map &GetPagePhrases(int page) const;
+    const std::unordered_map<std::string, std::vector<LVSearchPosting>> &GetTerms() const { return terms_; }
+    /// Marks pages where query may start. Query can only match on page p if any of its tokens
+    /// is a part of a term on page p or p + 1, or of the word split between them.
+    /// Pages not indexed yet are always marked.
+    const std::vector<bool> &FindCandidatePages(const lString16 &query);
+};
+
+#endif //_OPENREADERA_LVSEARCHINDEX_H_
@@ -178,6 +178,8 @@ typedef struct
    lUInt32               height;        /**< height of text fragment */
    lUInt16               width;         /**< width of text fragment */
    lUInt16               page_height;   /**< max page height */
+   lUInt16               page_height_min; /**< min page height giving the same object sizes */
+   lUInt16               page_height_max; /**< max page height giving the same object sizes */
    lInt32                img_zoom_in_mode_block; /**< can zoom in block images: 0=disabled, 1=integer scale, 2=free scale */
    lInt32                img_zoom_in_scale_block; /**< max scale for block images zoom in: 1, 2, 3 */
    lInt32                img_zoom_in_mode_inline; /**< can zoom in inline images: 0=disabled, 1=integer scale, 2=free scale */
@@ -311,6 +313,13 @@ public:
         return m_pbuffer->width;
     }
 
+    /// returns range of page heights for which last Format() gives the same result
+    void GetPageHeightRange(int & minHeight, int & maxHeight)
+    {
+        minHeight = m_pbuffer->page_height_min;
+        maxHeight = m_pbuffer->page_height_max;
+    }
+
     const src_text_fragment_t * GetSrcInfo(int index)
     {
         return &m_pbuffer->srctext[index];
@@ -656,6 +656,8 @@ public:
     LVStreamRef createBase64Stream();
     /// returns object image source
     LVImageSourceRef getObjectImageSource();
+    /// returns object image source decoded at dx x dy, cached by document
+    LVImageSourceRef getScaledObjectImageSource( int dx, int dy );
     /// returns object image ref name
     lString16 getObjectImageRefName();
     /// returns object image stream
@@ -868,6 +870,7 @@ protected:
     lString16HashedCollection _attrValueTable;
     LVHashTable<lUInt16,lInt32> _idNodeMap; // id to data index map
     LVHashTable<lString16,LVImageSourceRef> _urlImageMap; // url to image source map
+    LVScaledImageCache _scaledImageCache; // images decoded at drawing size
     lUInt16 _idAttrId; // Id for "id" attribute name
     lUInt16 _nameAttrId; // Id for "name" attribute name
 
@@ -1657,6 +1660,8 @@ public:
 };
 typedef LVRef<ListNumberingProps> ListNumberingPropsRef;
 
+struct ProgressiveRenderState;
+
 class CrDom : public CrDomXml
 {
     friend class LvDomWriter;
@@ -1674,8 +1679,32 @@ private:
     LVContainerRef _container;
     LVHashTable<lUInt32, ListNumberingPropsRef> lists;
     LVEmbeddedFontList _fontList;
+    lString8 _layoutCacheFile;
+    ProgressiveRenderState* _progressive;
+    /// lines of last render, kept to split pages again when only page height is changed
+    LVRendPageContext* _splitContext;
+    int _splitY0;
+    bool _splitShowCover;
+    /// range of page heights giving the same layout as last render
+    int _layoutPageHeightMin;
+    int _layoutPageHeightMax;
+    /// finalizes pages of completed progressive render
+    int finishProgressiveRender();
+    /// returns true if styles and render methods are valid for current settings
+    bool checkStyleContext();
+    /// drops kept lines, starts tracking page heights range of new layout
+    void resetSplitContext();
+    /// splits pages of last render for new page height, returns false if layout should be redone
+    bool resplitPages(LVRendPageList* pages, int width, int dy, bool showCover, int y0,
+            int interline_space);
 protected:
     void applyDocStylesheet();
+    lUInt32 calcStylesheetHash();
+    /// restores element render rects and page list saved for the same render context
+    bool loadLayoutCache(LVRendPageList* pages, int width, int dy, bool showCover, int y0,
+            int interline_space);
+    void saveLayoutCache(LVRendPageList* pages, int width, int dy, bool showCover, int y0,
+            int interline_space);
 public:
     CrDom();
     virtual ~CrDom();
@@ -1708,6 +1737,8 @@ public:
     /// check document formatting parameters before render,
     /// whether we need to reformat; returns false if render is necessary
     bool checkRenderContext();
+    /// sets file to keep formatting result between document opens, empty to disable
+    void setLayoutCacheFile(const lString8& path) { _layoutCacheFile = path; }
     LVContainerRef getDocParentContainer() { return _container; }
     void setDocParentContainer( LVContainerRef cont ) { _container = cont; }
     void clearRendBlockCache() { _renderedBlockCache.clear(); }
@@ -1726,9 +1757,32 @@ public:
     css_style_ref_t getDefaultStyle() { return _def_style; }
     inline bool parseStyleSheet(lString16 codeBase, lString16 css);
     inline bool parseStyleSheet(lString16 cssFile);
-    /// renders (formats) document in memory
+    /// renders (formats) document in memory,
+    /// with firstBlocks>0 stops after that many final blocks and fills pages of rendered part
     virtual int render(LVRendPageList* pages, int width, int dy,
-    		bool showCover, int y0, font_ref_t def_font, int def_interline_space );
+    		bool showCover, int y0, font_ref_t def_font, int def_interline_space,
+    		int firstBlocks = 0 );
+    /// returns true if render stopped before end of document
+    bool isRenderInProgress() { return _progressive != NULL; }
+    /// renders next maxBlocks final blocks, whole rest of document if 0,
+    /// returns true when document is rendered completely
+    bool continueRender(int maxBlocks);
+    /// refills page list with pages of rendered part
+    void updateProgressivePages();
+    /// returns rendered percent of progressive render
+    int getRenderProgress();
+    /// drops unfinished progressive render
+    void dropProgressiveRender();
+    /// narrows range of page heights giving the same layout, called for every formatted block
+    void limitLayoutPageHeight(int minHeight, int maxHeight)
+    {
+        if (_layoutPageHeightMin < minHeight) {
+            _layoutPageHeightMin = minHeight;
+        }
+        if (_layoutPageHeightMax > maxHeight) {
+            _layoutPageHeightMax = maxHeight;
+        }
+    }
     /// renders (formats) document in memory
     virtual bool
     setRenderProps(int width, int height, font_ref_t def_font, int def_interline_space);
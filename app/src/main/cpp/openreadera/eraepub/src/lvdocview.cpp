@@ -30,6 +30,7 @@
 #include "include/fb2fmt.h"
 #include "include/fb3fmt.h"
 #include "include/odthandler.h"
+#include "include/lvlayoutcache.h"
 
 #if 0
 #define REQUEST_RENDER(caller) { CRLog::trace("RequestRender " caller); RequestRender(); }
@@ -66,7 +67,8 @@ LVDocView::LVDocView()
           cfg_embeded_fonts_(false),
           cfg_enable_footnotes_(true),
           cfg_firstpage_thumb_(false),
-          cfg_txt_smart_format_(true)
+          cfg_txt_smart_format_(true),
+          cfg_progressive_render_(0)
 {
     cfg_font_face_ = lString8("Arial, Roboto");
     base_font_ = fontMan->GetFont(cfg_font_size_, 400, false, DEF_FONT_FAMILY, cfg_font_face_);
@@ -91,6 +93,7 @@ void LVDocView::Clear()
     position_is_set_ = false;
     show_cover_ = false;
     is_rendered_ = false;
+    search_index_.Reset(0);
     bookmark_ = ldomXPointer();
     bookmark_.clear();
     doc_props_->clear();
@@ -117,7 +120,7 @@ void LVDocView::CreateEmptyDom()
     bookmark_ranges_.clear();
 }
 
-void LVDocView::RenderIfDirty()
+void LVDocView::RenderIfDirty(int firstBlocks)
 {
     if (is_rendered_)
     {
@@ -136,7 +139,9 @@ void LVDocView::RenderIfDirty()
             return;
         }
         int y0 = show_cover_ ? dy + margins_.bottom * 4 : 0;
-        cr_dom_->render(&pages_list_, dx, dy, show_cover_, y0, base_font_, cfg_interline_space_);
+        cr_dom_->render(&pages_list_, dx, dy, show_cover_, y0, base_font_, cfg_interline_space_,
+                firstBlocks);
+        search_index_.Reset(pages_list_.length());
         fontMan->gc();
         is_rendered_ = true;
         UpdateSelections();
@@ -144,6 +149,47 @@ void LVDocView::RenderIfDirty()
     }
 }
 
+bool LVDocView::IsRenderInProgress()
+{
+    return is_rendered_ && cr_dom_ && cr_dom_->isRenderInProgress();
+}
+
+bool LVDocView::ContinueRender(int maxBlocks)
+{
+    if (!IsRenderInProgress())
+    {
+        return true;
+    }
+    if (!cr_dom_->continueRender(maxBlocks))
+    {
+        return false;
+    }
+    // Same as RenderIfDirty() after complete render
+    search_index_.Reset(pages_list_.length());
+    fontMan->gc();
+    UpdateSelections();
+    UpdateBookmarksRanges();
+    return true;
+}
+
+void LVDocView::UpdateRenderedPages()
+{
+    if (IsRenderInProgress())
+    {
+        cr_dom_->updateProgressivePages();
+        search_index_.Reset(pages_list_.length());
+    }
+}
+
+int LVDocView::GetRenderProgress()
+{
+    if (!is_rendered_ || !cr_dom_)
+    {
+        return 0;
+    }
+    return cr_dom_->getRenderProgress();
+}
+
 /// Invalidate formatted data, request render
 void LVDocView::RequestRender()
 {
@@ -643,6 +689,11 @@ bool LVDocView::LoadDoc(int doc_format, LVStreamRef stream)
     }
 #endif
 #endif
+    // Thumbnail DOM is partial, its layout is never worth keeping
+    if (!cfg_layout_cache_dir_.empty() && !cfg_firstpage_thumb_)
+    {
+        cr_dom_->setLayoutCacheFile(LayoutCacheFileName(cfg_layout_cache_dir_, stream_, doc_format));
+    }
     offset_ = 0;
     page_ = 0;
     //show_cover_ = !getCoverPageImage().isNull();
@@ -4771,141 +4822,48 @@ lString16 LVDocView::GetXpathByRectCoords(lString16 key, ldomWordMap m)
     }
 }
 
-void insert(lString16Map &map, std::string word)
+void LVDocView::IndexPageForSearch(int page_index)
 {
-    if(map.find(word) != map.end())
-    {
-        map[word]++;
-    }
-    else
+    CHECK_RENDER("IndexPageForSearch()")
+    if (page_index < 0 || page_index >= pages_list_.length() || search_index_.IsIndexed(page_index))
     {
-        map.insert(lString16Map::value_type(word, 1));
+        return;
     }
+    search_index_.AddPage(page_index, GetPageText(page_index));
 }
 
-lString16Map LVDocView::GetWordsIndexesMap()
+const std::vector<bool> &LVDocView::GetSearchCandidatePages(lString16 query)
 {
-    lString16Map result;
-
-    LVArray<ldomWord> list;
-    for (int page_index = 0; page_index < this->GetPagesCount(); page_index++)
-    {
-
-        lString16 pagetext = this->GetPageText(page_index);
-
-        pagetext.replaceAllPunctuation(L" ");
-        pagetext = pagetext.ReplaceUnusualSpaces();
-        pagetext.trimDoubleSpaces(false, false, false);
-        lString16Collection collection;
-        collection.parse(pagetext, ' ', true);
-
-        for (int i = 0; i < collection.length(); i++)
-        {
-            lString16 curr = collection.at(i);
-            curr = curr.lowercase();
-            insert(result, std::string(LCSTR(curr)));
-            //CRLog::error("word = %s", LCSTR(curr));
-        }
-    }
-
-    return result;
+    CHECK_RENDER("GetSearchCandidatePages()")
+    return search_index_.FindCandidatePages(query);
 }
 
-LVArray<lString16> subset(LVArray<lString16> arr, int startindex, int num)
+lString16Map LVDocView::GetWordsIndexesMap()
 {
-    LVArray<lString16> result;
-    if(num==0)
-    {
-        return result;
-    }
-    if(num==1)
+    lString16Map result;
+    for (int page_index = 0; page_index < this->GetPagesCount(); page_index++)
     {
-        return arr;
+        IndexPageForSearch(page_index);
     }
-
-    for (int j = startindex; j < startindex + num; j++)
+    const auto &terms = search_index_.GetTerms();
+    for (auto it = terms.begin(); it != terms.end(); ++it)
     {
-        if (j >= arr.length())
+        if (LVSearchIndex::IsPunctuation(Utf8ToUnicode(it->first.c_str())))
         {
-            break;
+            continue;
         }
-        result.add(arr.get(j));
+        result[it->first] = (int) it->second.size();
     }
     return result;
 }
 
-bool CheckIfSetHasPunctuation(LVArray<lString16> set)
-{
-    for (int i = 0; i < set.length(); i++)
-    {
-        lString16 curr = set.get(i);
-        if (curr.CheckIfHasPunctuation())
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
 lString16Map LVDocView::GetPhrasesIndexesMapForPage(int page_index)
 {
-    lString16Map result;
-
-    lString16 pagetext = this->GetPageText(page_index);
-
-    pagetext.lowercase();
-    pagetext.AddtoAllPunctuation(L" ", L" ");
-
-    pagetext = pagetext.ReplaceUnusualSpaces();
-    pagetext.trimDoubleSpaces(false, false, false);
-    lString16Collection collection;
-    collection.parse(pagetext, ' ', true);
-    LVArray<lString16> coll;
-    for (int i = 0; i < collection.length(); i++)
+    IndexPageForSearch(page_index);
+    if (!search_index_.IsIndexed(page_index))
     {
-        coll.add(collection.at(i));
+        return lString16Map();
     }
-    LVArray<LVArray<lString16>> bigarray;
-
-    for (int i = 0; i < coll.length(); i++)
-    {
-        LVArray<lString16> temp2 = subset(coll, i, 2);
-        LVArray<lString16> temp3 = subset(coll, i, 3);
-        bigarray.add(temp2);
-        bigarray.add(temp3);
-    }
-
-    for (int i = 0; i < coll.length(); i++)
-    {
-        lString16 curr = coll.get(i);
-        if (curr.length() < 3 || curr.CheckIfHasPunctuation())
-        {
-            continue;
-        }
-        insert(result, std::string(LCSTR(curr)));
-    }
-
-    for (int i = 0; i < bigarray.length(); i++)
-    {
-        LVArray<lString16> currarr = bigarray.get(i);
-        if (CheckIfSetHasPunctuation(currarr))
-        {
-            continue;
-        }
-        if (currarr.get(0).length() < 3 || currarr.get(currarr.length() - 1).length() < 3)
-        {
-            continue;
-        }
-        lString16 str;
-        for (int j = 0; j < currarr.length(); j++)
-        {
-            str += currarr.get(j);
-            str += L" ";
-        }
-        str = str.substr(0, str.length() - 1);
-        insert(result, std::string(LCSTR(str)));
-    }
-
-    return result;
+    return search_index_.GetPagePhrases(page_index);
 }
 
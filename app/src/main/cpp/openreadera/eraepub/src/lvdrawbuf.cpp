@@ -79,6 +79,13 @@ static lUInt8 rgbToGrayMask( lUInt32 color, int bpp )
     return (lUInt8)color;
 }
 
+/// converts 32bpp pixel between CR (0xAARRGGBB, A=0 opaque) and client RGBA byte order
+/// (R,G,B,A bytes in little endian memory, A=0xFF opaque); conversion is its own inverse
+static inline lUInt32 SwapRGBA( lUInt32 cl )
+{
+    return ((cl & 0xFF) << 16) | ((cl >> 16) & 0xFF) | (cl & 0xFF00) | (~cl & 0xFF000000);
+}
+
 static void ApplyAlphaRGB( lUInt32 &dst, lUInt32 src, lUInt32 alpha )
 {
     if ( alpha==0 )
@@ -92,6 +99,211 @@ static void ApplyAlphaRGB( lUInt32 &dst, lUInt32 src, lUInt32 alpha )
     }
 }
 
+/*
+   32bpp line kernels used by text, fill and image drawing.
+   NEON is always present on arm64 and enabled by default for armeabi-v7a,
+   SSE2 is part of x86/x86_64 ABI baseline, so the kernel is selected per ABI.
+   Every kernel produces exactly the same pixels as its scalar version.
+*/
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CR_DRAWBUF_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CR_DRAWBUF_SSE2 1
+#endif
+
+#if CR_DRAWBUF_SSE2
+static inline __m128i SwapRGBA4( __m128i v )
+{
+    const __m128i m00FF = _mm_set1_epi32(0xFF);
+    __m128i rb = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, m00FF), 16),
+                              _mm_and_si128(_mm_srli_epi32(v, 16), m00FF));
+    __m128i ga = _mm_or_si128(_mm_and_si128(v, _mm_set1_epi32(0xFF00)),
+                              _mm_andnot_si128(v, _mm_set1_epi32((int)0xFF000000)));
+    return _mm_or_si128(rb, ga);
+}
+#elif CR_DRAWBUF_NEON
+static inline uint32x4_t SwapRGBA4( uint32x4_t v )
+{
+    const uint32x4_t m00FF = vdupq_n_u32(0xFF);
+    uint32x4_t rb = vorrq_u32(vshlq_n_u32(vandq_u32(v, m00FF), 16),
+                              vandq_u32(vshrq_n_u32(v, 16), m00FF));
+    uint32x4_t ga = vorrq_u32(vandq_u32(v, vdupq_n_u32(0xFF00)),
+                              vbicq_u32(vdupq_n_u32(0xFF000000), v));
+    return vorrq_u32(rb, ga);
+}
+#endif
+
+/// fills count pixels with color
+static inline void FillLine32( lUInt32 * dst, int count, lUInt32 cl )
+{
+    int x = 0;
+#if CR_DRAWBUF_SSE2
+    const __m128i v = _mm_set1_epi32((int)cl);
+    for ( ; x + 4 <= count; x += 4 )
+        _mm_storeu_si128((__m128i *)(dst + x), v);
+#elif CR_DRAWBUF_NEON
+    const uint32x4_t v = vdupq_n_u32(cl);
+    for ( ; x + 4 <= count; x += 4 )
+        vst1q_u32((uint32_t *)(dst + x), v);
+#endif
+    for ( ; x < count; x++ )
+        dst[x] = cl;
+}
+
+/// blends color with constant alpha (1..254) over count pixels, same as ApplyAlphaRGB;
+/// result alpha byte is set to resA
+static inline void BlendLine32( lUInt32 * dst, int count, lUInt32 cl, lUInt32 alpha, lUInt32 resA )
+{
+    int x = 0;
+    lUInt32 opaque = 256 - alpha;
+#if CR_DRAWBUF_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i src16 = _mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)cl), zero), _mm_set1_epi16((short)opaque));
+    const __m128i alpha16 = _mm_set1_epi16((short)alpha);
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i alphaBits = _mm_set1_epi32((int)resA);
+    for ( ; x + 4 <= count; x += 4 ) {
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+        __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), alpha16), src16), 8);
+        __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), alpha16), src16), 8);
+        __m128i r = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(lo, hi), rgbMask), alphaBits);
+        _mm_storeu_si128((__m128i *)(dst + x), r);
+    }
+#elif CR_DRAWBUF_NEON
+    const uint16x8_t src16 = vmull_u8(vreinterpret_u8_u32(vdup_n_u32(cl)), vdup_n_u8((lUInt8)opaque));
+    const uint8x8_t alpha8 = vdup_n_u8((lUInt8)alpha);
+    const uint8x16_t rgbMask = vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF));
+    const uint8x16_t alphaBits = vreinterpretq_u8_u32(vdupq_n_u32(resA));
+    for ( ; x + 4 <= count; x += 4 ) {
+        uint8x16_t d = vld1q_u8((const uint8_t *)(dst + x));
+        uint8x8_t lo = vshrn_n_u16(vmlal_u8(src16, vget_low_u8(d), alpha8), 8);
+        uint8x8_t hi = vshrn_n_u16(vmlal_u8(src16, vget_high_u8(d), alpha8), 8);
+        uint8x16_t r = vorrq_u8(vandq_u8(vcombine_u8(lo, hi), rgbMask), alphaBits);
+        vst1q_u8((uint8_t *)(dst + x), r);
+    }
+#endif
+    for ( ; x < count; x++ ) {
+        lUInt32 n1 = (((dst[x] & 0xFF00FF) * alpha + (cl & 0xFF00FF) * opaque) >> 8) & 0xFF00FF;
+        lUInt32 n2 = (((dst[x] & 0x00FF00) * alpha + (cl & 0x00FF00) * opaque) >> 8) & 0x00FF00;
+        dst[x] = n1 | n2 | resA;
+    }
+}
+
+/// blends count pixels of 8-bit antialiased glyph bitmap using color;
+/// alpha byte of partially covered pixels is set to blendA
+static inline void BlendGlyphLine32( lUInt32 * dst, const lUInt8 * src, int count, lUInt32 cl, lUInt32 blendA )
+{
+    int x = 0;
+#if CR_DRAWBUF_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i color = _mm_set1_epi32((int)cl);
+    const __m128i color16 = _mm_unpacklo_epi8(color, zero);
+    const __m128i max16 = _mm_set1_epi16(0x7F);
+    const __m128i full = _mm_set1_epi32(0x77);
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i alphaBits = _mm_set1_epi32((int)blendA);
+    for ( ; x + 4 <= count; x += 4 ) {
+        lUInt32 s4;
+        memcpy(&s4, src + x, 4);
+        if ( !s4 )
+            continue; // glyph spacing, nothing to draw
+        __m128i o = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)s4), zero), zero);
+        o = _mm_srli_epi32(o, 1);
+        // opaque value per 16-bit channel: pixels 0,1 in lo, 2,3 in hi
+        __m128i o16 = _mm_or_si128(o, _mm_slli_epi32(o, 16));
+        __m128i oLo = _mm_unpacklo_epi32(o16, o16);
+        __m128i oHi = _mm_unpackhi_epi32(o16, o16);
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + x));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(max16, oLo), _mm_unpacklo_epi8(d, zero)),
+                                   _mm_mullo_epi16(oLo, color16));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(max16, oHi), _mm_unpackhi_epi8(d, zero)),
+                                   _mm_mullo_epi16(oHi, color16));
+        __m128i r = _mm_packus_epi16(_mm_srli_epi16(lo, 7), _mm_srli_epi16(hi, 7));
+        r = _mm_or_si128(_mm_and_si128(r, rgbMask), alphaBits);
+        __m128i isFull = _mm_cmpgt_epi32(o, full);
+        __m128i isNone = _mm_cmpeq_epi32(o, zero);
+        r = _mm_or_si128(_mm_and_si128(isFull, color), _mm_andnot_si128(isFull, r));
+        r = _mm_or_si128(_mm_and_si128(isNone, d), _mm_andnot_si128(isNone, r));
+        _mm_storeu_si128((__m128i *)(dst + x), r);
+    }
+#elif CR_DRAWBUF_NEON
+    static const lUInt8 spreadLo[8] = { 0, 0, 0, 0, 1, 1, 1, 1 };
+    static const lUInt8 spreadHi[8] = { 2, 2, 2, 2, 3, 3, 3, 3 };
+    const uint8x8_t idxLo = vld1_u8(spreadLo);
+    const uint8x8_t idxHi = vld1_u8(spreadHi);
+    const uint8x16_t color = vreinterpretq_u8_u32(vdupq_n_u32(cl));
+    const uint8x8_t color8 = vget_low_u8(color);
+    const uint8x16_t rgbMask = vreinterpretq_u8_u32(vdupq_n_u32(0x00FFFFFF));
+    const uint8x16_t alphaBits = vreinterpretq_u8_u32(vdupq_n_u32(blendA));
+    for ( ; x + 4 <= count; x += 4 ) {
+        lUInt32 s4;
+        memcpy(&s4, src + x, 4);
+        if ( !s4 )
+            continue; // glyph spacing, nothing to draw
+        // opaque value spread over 4 bytes of each pixel
+        uint8x8_t s = vreinterpret_u8_u32(vdup_n_u32(s4));
+        uint8x16_t o = vshrq_n_u8(vcombine_u8(vtbl1_u8(s, idxLo), vtbl1_u8(s, idxHi)), 1);
+        uint8x16_t a = vsubq_u8(vdupq_n_u8(0x7F), o);
+        uint8x16_t d = vld1q_u8((const uint8_t *)(dst + x));
+        uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), vget_low_u8(d)), vget_low_u8(o), color8);
+        uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), vget_high_u8(d)), vget_high_u8(o), color8);
+        uint8x16_t r = vcombine_u8(vshrn_n_u16(lo, 7), vshrn_n_u16(hi, 7));
+        r = vorrq_u8(vandq_u8(r, rgbMask), alphaBits);
+        r = vbslq_u8(vcgtq_u8(o, vdupq_n_u8(0x77)), color, r);
+        r = vbslq_u8(vceqq_u8(o, vdupq_n_u8(0)), d, r);
+        vst1q_u8((uint8_t *)(dst + x), r);
+    }
+#endif
+    for ( ; x < count; x++ ) {
+        lUInt32 opaque = (src[x] >> 1) & 0x7F;
+        if ( opaque >= 0x78 )
+            dst[x] = cl;
+        else if ( opaque > 0 ) {
+            lUInt32 alpha = 0x7F - opaque;
+            lUInt32 cl1 = ((alpha*(dst[x]&0xFF00FF) + opaque*(cl&0xFF00FF))>>7) & 0xFF00FF;
+            lUInt32 cl2 = ((alpha*(dst[x]&0x00FF00) + opaque*(cl&0x00FF00))>>7) & 0x00FF00;
+            dst[x] = cl1 | cl2 | blendA;
+        }
+    }
+}
+
+/// copies leading groups of 4 fully opaque image pixels and skips fully transparent ones,
+/// converting to RGBA order if requested; returns number of pixels processed
+static inline int CopyImageRun32( lUInt32 * dst, const lUInt32 * src, int count, bool rgba )
+{
+    int x = 0;
+#if CR_DRAWBUF_SSE2
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+    const __m128i zero = _mm_setzero_si128();
+    for ( ; x + 4 <= count; x += 4 ) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + x));
+        __m128i a = _mm_and_si128(s, alphaMask);
+        if ( _mm_movemask_epi8(_mm_cmpeq_epi32(a, alphaMask)) == 0xFFFF )
+            continue;
+        if ( _mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) != 0xFFFF )
+            break;
+        _mm_storeu_si128((__m128i *)(dst + x), rgba ? SwapRGBA4(s) : s);
+    }
+#elif CR_DRAWBUF_NEON
+    for ( ; x + 4 <= count; x += 4 ) {
+        uint32x4_t s = vld1q_u32((const uint32_t *)(src + x));
+        uint32x4_t a = vshrq_n_u32(s, 24);
+        uint32x2_t mn = vpmin_u32(vget_low_u32(a), vget_high_u32(a));
+        uint32x2_t mx = vpmax_u32(vget_low_u32(a), vget_high_u32(a));
+        if ( vget_lane_u32(vpmin_u32(mn, mn), 0) == 0xFF )
+            continue;
+        if ( vget_lane_u32(vpmax_u32(mx, mx), 0) != 0 )
+            break;
+        vst1q_u32((uint32_t *)(dst + x), rgba ? SwapRGBA4(s) : s);
+    }
+#else
+    CR_UNUSED4(dst, src, count, rgba);
+#endif
+    return x;
+}
+
 static void ApplyAlphaRGB565( lUInt16 &dst, lUInt16 src, lUInt32 alpha )
 {
     if ( alpha==0 )
@@ -339,20 +551,34 @@ public:
             {
                 lUInt32 * row = (lUInt32 *)dst->GetScanLine( yy + dst_y );
                 row += dst_x;
-                for (int x=0; x<dst_dx; x++)
+                bool rgba = dst->IsRGBA();
+                int xStart = clip.left > dst_x ? clip.left - dst_x : 0;
+                int xEnd = clip.right - dst_x < dst_dx ? clip.right - dst_x : dst_dx;
+                for (int x=xStart; x<xEnd; )
                 {
-                    lUInt32 cl = data[xmap ? xmap[x] : x];
-                    int xx = x + dst_x;
-                    lUInt32 alpha = (cl >> 24)&0xFF;
-                    if ( xx<clip.left || xx>=clip.right || alpha==0xFF )
-                        continue;
-                    if ( !alpha )
-                        row[ x ] = cl;
-                    else {
-                    	if ((row[x] & 0xFF000000) == 0xFF000000)
-                            row[ x ] = cl; // copy as is if buffer pixel is transparent
-                    	else
-                    		ApplyAlphaRGB( row[x], cl, alpha );
+                    int groupEnd = xEnd;
+                    if ( !xmap ) {
+                        // opaque and transparent runs are handled by line kernel
+                        x += CopyImageRun32( row + x, data + x, xEnd - x, rgba );
+                        if ( groupEnd > x + 4 )
+                            groupEnd = x + 4;
+                    }
+                    for ( ; x<groupEnd; x++ )
+                    {
+                        lUInt32 cl = data[xmap ? xmap[x] : x];
+                        lUInt32 alpha = (cl >> 24)&0xFF;
+                        if ( alpha==0xFF )
+                            continue;
+                        if ( !alpha )
+                            row[ x ] = rgba ? SwapRGBA(cl) : cl;
+                        else {
+                            lUInt32 v = rgba ? SwapRGBA(row[x]) : row[x];
+                            if ((v & 0xFF000000) == 0xFF000000)
+                                v = cl; // copy as is if buffer pixel is transparent
+                            else
+                                ApplyAlphaRGB( v, cl, alpha );
+                            row[ x ] = rgba ? SwapRGBA(v) : v;
+                        }
                     }
                 }
             }
@@ -1081,14 +1307,10 @@ void LVColorDrawBuf::Clear( lUInt32 color )
             }
         }
     } else {
+        if ( _rgba )
+            color = SwapRGBA(color);
         for (int y=0; y<_dy; y++)
-        {
-            lUInt32 * line = (lUInt32 *)GetScanLine(y);
-            for (int x=0; x<_dx; x++)
-            {
-                line[x] = color;
-            }
-        }
+            FillLine32((lUInt32 *)GetScanLine(y), _dx, color);
     }
 }
 
@@ -1100,7 +1322,8 @@ lUInt32 LVColorDrawBuf::GetPixel( int x, int y )
         return 0;
     if ( _bpp==16 )
         return rgb565to888(((lUInt16*)GetScanLine(y))[x]);
-    return ((lUInt32*)GetScanLine(y))[x];
+    lUInt32 cl = ((lUInt32*)GetScanLine(y))[x];
+    return _rgba ? SwapRGBA(cl) : cl;
 }
 
 inline static lUInt32 AA(lUInt32 color) {
@@ -1257,17 +1480,21 @@ void LVColorDrawBuf::FillRect( int x0, int y0, int x1, int y1, lUInt32 color )
                     line[x] = cl16;
             }
         }
-    } else {
+    } else if ( alpha < 0xFF ) {
+        // alpha blending is symmetric in R and B, so RGBA buffer only needs
+        // color swapped and opaque alpha byte in result
+        lUInt32 resA = 0;
+        if ( _rgba ) {
+            color = SwapRGBA(color);
+            resA = 0xFF000000;
+        }
         for (int y=y0; y<y1; y++)
         {
-            lUInt32 * line = (lUInt32 *)GetScanLine(y);
-            for (int x=x0; x<x1; x++)
-            {
-                if (alpha)
-                    ApplyAlphaRGB(line[x], color, alpha);
-                else
-                    line[x] = color;
-            }
+            lUInt32 * line = (lUInt32 *)GetScanLine(y) + x0;
+            if (alpha)
+                BlendLine32(line, x1 - x0, color, alpha, resA);
+            else
+                FillLine32(line, x1 - x0, color);
         }
     }
 }
@@ -1299,6 +1526,10 @@ void LVColorDrawBuf::FillRectPattern( int x0, int y0, int x1, int y1, lUInt32 co
             }
         }
     } else {
+        if ( _rgba ) {
+            color0 = SwapRGBA(color0);
+            color1 = SwapRGBA(color1);
+        }
         for (int y=y0; y<y1; y++)
         {
             lUInt8 patternMask = pattern[y & 3];
@@ -1467,30 +1698,18 @@ void LVColorDrawBuf::Draw( int x, int y, const lUInt8 * bitmap, int width, int h
     } else {
 
 
-        lUInt32 * dst;
         lUInt32 * dstline;
-
+        // blending is symmetric in R and B, so only solid color and alpha byte depend on format
+        lUInt32 blendA = 0;
+        if ( _rgba ) {
+            bmpcl = SwapRGBA(bmpcl);
+            blendA = 0xFF000000;
+        }
 
         for (;height;height--)
         {
-            src = bitmap;
             dstline = ((lUInt32*)GetScanLine(y++)) + x;
-            dst = dstline;
-
-            for (xx = width; xx>0; --xx)
-            {
-                lUInt32 opaque = ((*(src++))>>1)&0x7F;
-                if ( opaque>=0x78 )
-                    *dst = bmpcl;
-                else if ( opaque>0 ) {
-                    lUInt32 alpha = 0x7F-opaque;
-                    lUInt32 cl1 = ((alpha*((*dst)&0xFF00FF) + opaque*(bmpcl&0xFF00FF))>>7) & 0xFF00FF;
-                    lUInt32 cl2 = ((alpha*((*dst)&0x00FF00) + opaque*(bmpcl&0x00FF00))>>7) & 0x00FF00;
-                    *dst = cl1 | cl2;
-                }
-                /* next pixel */
-                dst++;
-            }
+            BlendGlyphLine32(dstline, bitmap, width, bmpcl, blendA);
             /* new dest line */
             bitmap += bmp_width;
         }
@@ -2079,7 +2298,7 @@ void LVColorDrawBuf::DrawRescaled(LVDrawBuf * src, int x, int y, int dx, int dy,
 							dst[x + xx] = rgb888to565(cl);
 						} else {
 							lUInt32 * dst = (lUInt32 *)GetScanLine(y + yy);
-							dst[x + xx] = cl;
+							dst[x + xx] = _rgba ? SwapRGBA(cl) : cl;
 						}
 					}
 				}
@@ -2098,7 +2317,7 @@ void LVColorDrawBuf::DrawRescaled(LVDrawBuf * src, int x, int y, int dx, int dy,
 							dst[x + xx] = rgb888to565(cl);
 						} else {
 							lUInt32 * dst = (lUInt32 *)GetScanLine(y + yy);
-							dst[x + xx] = cl;
+							dst[x + xx] = _rgba ? SwapRGBA(cl) : cl;
 						}
 					}
 				}
@@ -2140,13 +2359,14 @@ LVColorDrawBuf::LVColorDrawBuf(int dx, int dy, int bpp)
 #endif
     ,_bpp(bpp)
     ,_ownData(true)
+    ,_rgba(false)
 {
     _rowsize = dx*(_bpp>>3);
     Resize( dx, dy );
 }
 
-/// creates wrapper around external RGBA buffer
-LVColorDrawBuf::LVColorDrawBuf(int dx, int dy, lUInt8 * externalBuffer, int bpp )
+/// creates wrapper around external buffer
+LVColorDrawBuf::LVColorDrawBuf(int dx, int dy, lUInt8 * externalBuffer, int bpp, bool rgba )
 :     LVBaseDrawBuf()
 #if defined(_WIN32) && !defined(QT_GL)
     ,_drawdc(NULL)
@@ -2154,6 +2374,7 @@ LVColorDrawBuf::LVColorDrawBuf(int dx, int dy, lUInt8 * externalBuffer, int bpp
 #endif
     ,_bpp(bpp)
     ,_ownData(false)
+    ,_rgba(rgba && bpp == 32)
 {
     _dx = dx;
     _dy = dy;
@@ -504,8 +504,8 @@ class LVFreeTypeFace;
 static LVFontGlyphCacheItem * newItem( LVFontLocalGlyphCache * local_cache, lChar16 ch, FT_GlyphSlot slot ) // , bool drawMonochrome
 {
     FT_Bitmap*  bitmap = &slot->bitmap;
-    lUInt8 w = (lUInt8)(bitmap->width);
-    lUInt8 h = (lUInt8)(bitmap->rows);
+    int w = bitmap->width;
+    int h = bitmap->rows;
     LVFontGlyphCacheItem * item = LVFontGlyphCacheItem::newItem(local_cache, ch, w, h );
     if ( bitmap->pixel_mode==FT_PIXEL_MODE_MONO ) { //drawMonochrome
         lUInt8 mask = 0x80;
@@ -549,65 +549,138 @@ static LVFontGlyphCacheItem * newItem( LVFontLocalGlyphCache * local_cache, lCha
                 cr_correct_gamma_buf(item->bmp, w*h, gammaIndex);
 //            }
     }
-    item->origin_x =   (lInt8)slot->bitmap_left;
-    item->origin_y =   (lInt8)slot->bitmap_top;
-    item->advance =    (lUInt8)(myabs(slot->metrics.horiAdvance) >> 6);
+    item->origin_x =   (lInt16)slot->bitmap_left;
+    item->origin_y =   (lInt16)slot->bitmap_top;
+    item->advance =    (lUInt16)(myabs(slot->metrics.horiAdvance) >> 6);
     return item;
 }
 
 void LVFontLocalGlyphCache::clear()
 {
-    while ( head ) {
-        LVFontGlyphCacheItem * ptr = head;
-        remove( ptr );
-        global_cache->remove( ptr );
-        LVFontGlyphCacheItem::freeItem( ptr );
+    for ( int i=0; i<256 && size; i++ ) {
+        LVFontGlyphCacheItem ** page = pages[i];
+        if ( !page )
+            continue;
+        for ( int j=0; j<256; j++ ) {
+            LVFontGlyphCacheItem * ptr = page[j];
+            if ( ptr ) {
+                remove( ptr );
+                global_cache->remove( ptr );
+                LVFontGlyphCacheItem::freeItem( ptr );
+            }
+        }
+    }
+    for ( int i=0; i<256; i++ ) {
+        if ( pages[i] ) {
+            free( pages[i] );
+            pages[i] = NULL;
+        }
     }
 }
 
 LVFontGlyphCacheItem * LVFontLocalGlyphCache::get( lUInt16 ch )
 {
-    LVFontGlyphCacheItem * ptr = head;
-    for ( ; ptr; ptr = ptr->next_local ) {
-        if ( ptr->ch == ch ) {
-            global_cache->refresh( ptr );
-            return ptr;
-        }
-    }
-    return NULL;
+    LVFontGlyphCacheItem ** page = pages[ch >> 8];
+    LVFontGlyphCacheItem * ptr = page ? page[ch & 255] : NULL;
+    global_cache->onLookup( ptr!=NULL );
+    if ( ptr )
+        global_cache->refresh( ptr );
+    return ptr;
 }
 
 void LVFontLocalGlyphCache::put( LVFontGlyphCacheItem * item )
 {
     global_cache->put( item );
-    item->next_local = head;
-    if ( head )
-        head->prev_local = item;
-    if ( !tail )
-        tail = item;
-    head = item;
+    LVFontGlyphCacheItem ** & page = pages[item->ch >> 8];
+    if ( !page )
+        page = (LVFontGlyphCacheItem **)calloc( 256, sizeof(LVFontGlyphCacheItem *) );
+    LVFontGlyphCacheItem * & slot = page[item->ch & 255];
+    if ( slot && slot!=item ) {
+        // replaced glyph of the same char is dropped
+        global_cache->remove( slot );
+        LVFontGlyphCacheItem::freeItem( slot );
+        size--;
+    }
+    if ( slot!=item )
+        size++;
+    slot = item;
 }
 
-/// remove from list, but don't delete
+/// remove from table, but don't delete
 void LVFontLocalGlyphCache::remove( LVFontGlyphCacheItem * item )
 {
-    if ( item==head )
-        head = item->next_local;
-    if ( item==tail )
-        tail = item->prev_local;
-    if ( !head || !tail )
+    LVFontGlyphCacheItem ** page = pages[item->ch >> 8];
+    if ( page && page[item->ch & 255]==item ) {
+        page[item->ch & 255] = NULL;
+        size--;
+    }
+}
+
+int LVFontGlobalGlyphCache::sizeClass( int sz )
+{
+    int cls = 0;
+    while ( (32 << cls) < sz ) {
+        if ( ++cls >= GLYPH_CACHE_SIZE_CLASSES )
+            return -1;
+    }
+    return cls;
+}
+
+int LVFontGlobalGlyphCache::blockSize( int sz )
+{
+    int cls = sizeClass( sz );
+    return cls < 0 ? sz : (32 << cls);
+}
+
+void * LVFontGlobalGlyphCache::allocBlock( int sz )
+{
+    items++;
+    int cls = sizeClass( sz );
+    if ( cls < 0 )
+        return malloc( sz );
+    void * block = free_blocks[cls];
+    if ( block ) {
+        free_blocks[cls] = *(void **)block;
+        return block;
+    }
+    int bsz = 32 << cls;
+    if ( slab_left < bsz ) {
+        // rest of current slab is lost until slabs are released
+        slab_pos = (lUInt8 *)malloc( GLYPH_CACHE_SLAB_SIZE );
+        slab_left = GLYPH_CACHE_SLAB_SIZE;
+        slabs.add( slab_pos );
+    }
+    block = slab_pos;
+    slab_pos += bsz;
+    slab_left -= bsz;
+    return block;
+}
+
+void LVFontGlobalGlyphCache::freeBlock( void * block, int sz )
+{
+    items--;
+    int cls = sizeClass( sz );
+    if ( cls < 0 ) {
+        free( block );
         return;
-    if ( item->prev_local )
-        item->prev_local->next_local = item->next_local;
-    if ( item->next_local )
-        item->next_local->prev_local = item->prev_local;
-    item->next_local = NULL;
-    item->prev_local = NULL;
+    }
+    *(void **)block = free_blocks[cls];
+    free_blocks[cls] = block;
+}
+
+void LVFontGlobalGlyphCache::releaseSlabs()
+{
+    for ( int i=0; i<slabs.length(); i++ )
+        free( slabs[i] );
+    slabs.clear();
+    memset( free_blocks, 0, sizeof(free_blocks) );
+    slab_pos = NULL;
+    slab_left = 0;
 }
 
 void LVFontGlobalGlyphCache::refresh( LVFontGlyphCacheItem * item )
 {
-    if ( tail!=item ) {
+    if ( head!=item ) {
         //move to head
         removeNoLock( item );
         putNoLock( item );
@@ -621,7 +694,7 @@ void LVFontGlobalGlyphCache::put( LVFontGlyphCacheItem * item )
 
 void LVFontGlobalGlyphCache::putNoLock( LVFontGlyphCacheItem * item )
 {
-    int sz = item->getSize();
+    int sz = blockSize( item->getSize() );
     // remove extra items from tail
     while ( sz + size > max_size ) {
         LVFontGlyphCacheItem * removed_item = tail;
@@ -630,8 +703,10 @@ void LVFontGlobalGlyphCache::putNoLock( LVFontGlyphCacheItem * item )
         removeNoLock( removed_item );
         removed_item->local_cache->remove( removed_item );
         LVFontGlyphCacheItem::freeItem( removed_item );
+        evictions++;
     }
     // add new item to head
+    item->prev_global = NULL;
     item->next_global = head;
     if ( head )
         head->prev_global = item;
@@ -648,19 +723,19 @@ void LVFontGlobalGlyphCache::remove( LVFontGlyphCacheItem * item )
 
 void LVFontGlobalGlyphCache::removeNoLock( LVFontGlyphCacheItem * item )
 {
-    if ( item==head )
-        head = item->next_global;
-    if ( item==tail )
-        tail = item->prev_global;
-    if ( !head || !tail )
-        return;
     if ( item->prev_global )
         item->prev_global->next_global = item->next_global;
+    else if ( item==head )
+        head = item->next_global;
+    else
+        return; // not in list
     if ( item->next_global )
         item->next_global->prev_global = item->prev_global;
+    else
+        tail = item->prev_global;
     item->next_global = NULL;
     item->prev_global = NULL;
-    size -= item->getSize();
+    size -= blockSize( item->getSize() );
 }
 
 void LVFontGlobalGlyphCache::clear()
@@ -671,6 +746,32 @@ void LVFontGlobalGlyphCache::clear()
         ptr->local_cache->remove( ptr );
         LVFontGlyphCacheItem::freeItem( ptr );
     }
+    // slabs can be returned to system only when all glyphs are freed
+    if ( !items )
+        releaseSlabs();
+}
+
+void LVFontGlobalGlyphCache::setMaxSize( int maxSize )
+{
+    max_size = maxSize;
+    while ( size > max_size && tail ) {
+        LVFontGlyphCacheItem * removed_item = tail;
+        removeNoLock( removed_item );
+        removed_item->local_cache->remove( removed_item );
+        LVFontGlyphCacheItem::freeItem( removed_item );
+        evictions++;
+    }
+}
+
+void LVFontGlobalGlyphCache::getStats( LVFontGlyphCacheStats & stats )
+{
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.evictions = evictions;
+    stats.items = items;
+    stats.size = size;
+    stats.max_size = max_size;
+    stats.slab_size = slabs.length() * GLYPH_CACHE_SLAB_SIZE;
 }
 
 lString8 familyName( FT_Face face )
@@ -1303,8 +1404,8 @@ public:
     */
     virtual lUInt32 getTextWidth(const lChar16* text, int len)
     {
-        static lUInt16 widths[MAX_LINE_CHARS + 1];
-        static lUInt8 flags[MAX_LINE_CHARS + 1];
+        static thread_local lUInt16 widths[MAX_LINE_CHARS + 1];
+        static thread_local lUInt8 flags[MAX_LINE_CHARS + 1];
         if (len > MAX_LINE_CHARS) {
             len = MAX_LINE_CHARS;
         }
@@ -1631,7 +1732,6 @@ public:
 
 
             LVFontGlyphCacheItem * item = getGlyph(ch, def_char);
-                    _glyph_cache.get( ch );
             if ( !item )
                 continue;
             if ( (item && !isHyphen) || i>=len-1 ) { // avoid soft hyphens inside text string
@@ -1815,8 +1915,8 @@ public:
                         const lChar16 * text, int len
         )
     {
-        static lUInt16 widths[MAX_LINE_CHARS+1];
-        static lUInt8 flags[MAX_LINE_CHARS+1];
+        static thread_local lUInt16 widths[MAX_LINE_CHARS+1];
+        static thread_local lUInt8 flags[MAX_LINE_CHARS+1];
         if ( len>MAX_LINE_CHARS )
             len = MAX_LINE_CHARS;
         if ( len<=0 )
@@ -2461,6 +2561,16 @@ public:
     {
         _globalCache.clear();
     }
+    /// sets glyph cache size in bytes
+    virtual void setGlyphCacheSize( int size )
+    {
+        _globalCache.setMaxSize( size );
+    }
+    /// returns glyph cache statistics
+    virtual void getGlyphCacheStats( LVFontGlyphCacheStats & stats )
+    {
+        _globalCache.getStats( stats );
+    }
 
     virtual int GetFontCount()
     {
@@ -29,9 +29,9 @@
 
 #if (USE_LIBJPEG==1)
 extern "C" {
-#include "orelibjpeg/jpeglib.h"
+#include <jpeglib.h>
 }
-#include "orelibjpeg/jerror.h"
+#include <jerror.h>
 
 
 typedef boolean wxjpeg_boolean;
@@ -204,6 +204,11 @@ LVImageSource::~LVImageSource() {
 		delete _ninePatch;
 }
 
+LVImageSourceRef LVImageSource::GetReducedSource( int /*dx*/, int /*dy*/ )
+{
+    return LVImageSourceRef();
+}
+
 
 class LVNodeImageSource : public LVImageSource
 {
@@ -680,10 +685,12 @@ class LVJpegImageSource : public LVNodeImageSource
 {
     my_error_mgr jerr;
     jpeg_decompress_struct cinfo;
+    /// DCT scaling denominator: 1, 2, 4 or 8
+    int _scaleDenom;
 protected:
 public:
-    LVJpegImageSource( ldomNode * node, LVStreamRef stream )
-        : LVNodeImageSource(node, stream)
+    LVJpegImageSource( ldomNode * node, LVStreamRef stream, int scaleDenom = 1 )
+        : LVNodeImageSource(node, stream), _scaleDenom(scaleDenom)
     {
     	//CRLog::trace("creating LVJpegImageSource");
 
@@ -698,6 +705,22 @@ public:
     }
     virtual ~LVJpegImageSource() {}
     virtual void   Compact() { }
+    /// decodes image at 1/2, 1/4 or 1/8 size using DCT scaling if result is still not smaller than dx x dy
+    virtual LVImageSourceRef GetReducedSource( int dx, int dy )
+    {
+        if ( _scaleDenom != 1 )
+            return LVImageSourceRef();
+        // same rounding as in jpeg_calc_output_dimensions
+        int denom = 8;
+        while ( denom > 1 && ((_width + denom - 1) / denom < dx || (_height + denom - 1) / denom < dy) )
+            denom >>= 1;
+        if ( denom == 1 )
+            return LVImageSourceRef();
+        LVImageSourceRef ref( new LVJpegImageSource( _node, _stream, denom ) );
+        if ( !ref->Decode( NULL ) )
+            return LVImageSourceRef();
+        return ref;
+    }
     virtual bool   Decode( LVImageDecoderCallback * callback )
     {
     	//CRLog::trace("LVJpegImageSource::decode called");
@@ -748,6 +771,13 @@ public:
              */
             _width = cinfo.image_width;
             _height = cinfo.image_height;
+            if ( _scaleDenom > 1 ) {
+                cinfo.scale_num = 1;
+                cinfo.scale_denom = _scaleDenom;
+                jpeg_calc_output_dimensions(&cinfo);
+                _width = cinfo.output_width;
+                _height = cinfo.output_height;
+            }
             //fprintf(stderr, "    jpeg_read_header() finished succesfully: image size = %d x %d\n", _width, _height);
 
             if ( callback )
@@ -1781,9 +1811,16 @@ bool LVStretchImgSource::OnLineDecoded( LVImageSource * obj, int y, lUInt32 * da
         break;
     case IMG_TRANSFORM_TILE:
         {
-            int offset = _src_dx - _split_x;
-            for ( int x=0; x<_dst_dx; x++ )
-                _line[x] = data[ (x + offset) % _src_dx];
+            // copy whole runs of source line instead of per pixel modulo
+            int sx = (_src_dx - _split_x) % _src_dx;
+            for ( int x=0; x<_dst_dx; ) {
+                int count = _src_dx - sx;
+                if ( count > _dst_dx - x )
+                    count = _dst_dx - x;
+                memcpy( _line.get() + x, data + sx, count * sizeof(lUInt32) );
+                x += count;
+                sx = 0;
+            }
         }
         break;
     }
@@ -2234,4 +2271,55 @@ LVImageSourceRef LVCreateUnpackedImageSource( LVImageSourceRef srcImage, int max
 LVImageSourceRef LVCreateDrawBufImageSource( LVColorDrawBuf * buf, bool own )
 {
     return LVImageSourceRef( new LVDrawBufImgSource( buf, own ) );
+}
+
+LVImageSourceRef LVScaledImageCache::get( const lString16 & name, int dx, int dy )
+{
+    for ( int i=0; i<_items.length(); i++ ) {
+        Item * item = _items[i];
+        if ( item->dx==dx && item->dy==dy && item->name==name ) {
+            item->lastAccess = ++_accessCounter;
+            return item->img;
+        }
+    }
+    return LVImageSourceRef();
+}
+
+LVImageSourceRef LVScaledImageCache::put( const lString16 & name, LVImageSourceRef src, int dx, int dy )
+{
+    if ( src.isNull() || dx<=0 || dy<=0 )
+        return src;
+    int size = dx * dy * 4;
+    if ( size > _maxSize / 2 )
+        return src;
+    // let decoder skip unneeded resolution, e.g. JPEG DCT scaling
+    LVImageSourceRef reduced = src->GetReducedSource( dx, dy );
+    LVColorDrawBuf * buf = new LVColorDrawBuf( dx, dy, 32 );
+    buf->Clear( 0xFF000000 ); // transparent
+    buf->Draw( reduced.isNull() ? src : reduced, 0, 0, dx, dy, false );
+    // evict least recently used items
+    while ( _size + size > _maxSize && _items.length() > 0 ) {
+        int oldest = 0;
+        for ( int i=1; i<_items.length(); i++ )
+            if ( _items[i]->lastAccess < _items[oldest]->lastAccess )
+                oldest = i;
+        _size -= _items[oldest]->size;
+        _items.erase( oldest, 1 );
+    }
+    Item * item = new Item();
+    item->name = name;
+    item->dx = dx;
+    item->dy = dy;
+    item->size = size;
+    item->lastAccess = ++_accessCounter;
+    item->img = LVCreateDrawBufImageSource( buf, true );
+    _items.add( item );
+    _size += size;
+    return item->img;
+}
+
+void LVScaledImageCache::clear()
+{
+    _items.clear();
+    _size = 0;
 }
\ No newline at end of file
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#include <cstdint>
+#include <cstdio>
+
+#include "include/lvlayoutcache.h"
+
+#define LAYOUT_CACHE_SAMPLE_SIZE 0x10000
+
+static lUInt64 HashBytes(lUInt64 hash, const lUInt8* data, lvsize_t size)
+{
+    for (lvsize_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static lUInt64 HashStreamRange(lUInt64 hash, LVStreamRef stream, lvpos_t pos, lvsize_t size)
+{
+    lUInt8 buf[4096];
+    stream->SetPos(pos);
+    while (size > 0)
+    {
+        lvsize_t bytesRead = 0;
+        if (stream->Read(buf, size < sizeof(buf) ? size : sizeof(buf), &bytesRead) != LVERR_OK
+            || bytesRead == 0)
+        {
+            break;
+        }
+        hash = HashBytes(hash, buf, bytesRead);
+        size -= bytesRead;
+    }
+    return hash;
+}
+
+lString8 LayoutCacheFileName(const lString8& dir, LVStreamRef stream, int doc_format)
+{
+    lUInt64 hash = 14695981039346656037ULL;
+    lvsize_t size = stream->GetSize();
+    hash = HashBytes(hash, (const lUInt8*) &size, sizeof(size));
+    hash = HashBytes(hash, (const lUInt8*) &doc_format, sizeof(doc_format));
+    lvpos_t pos = stream->GetPos();
+    if (size <= 2 * LAYOUT_CACHE_SAMPLE_SIZE)
+    {
+        hash = HashStreamRange(hash, stream, 0, size);
+    }
+    else
+    {
+        hash = HashStreamRange(hash, stream, 0, LAYOUT_CACHE_SAMPLE_SIZE);
+        hash = HashStreamRange(hash, stream, size - LAYOUT_CACHE_SAMPLE_SIZE, LAYOUT_CACHE_SAMPLE_SIZE);
+    }
+    stream->SetPos(pos);
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.crlayout", (unsigned long long) hash);
+    lString8 path = dir;
+    if (!path.empty() && path[path.length() - 1] != '/')
+    {
+        path << "/";
+    }
+    path << name;
+    return path;
+}
+
+/// Everything that changes formatting result of the same document
+class LayoutCacheHeader
+{
+public:
+    lUInt32 version = LAYOUT_CACHE_VERSION;
+    lUInt32 style_hash = 0;
+    lUInt32 stylesheet_hash = 0;
+    lUInt32 doc_flags = 0;
+    lInt32 width = 0;
+    lInt32 height = 0;
+    lInt32 y0 = 0;
+    lInt32 interline_space = 0;
+    bool show_cover = false;
+    lInt32 elem_count = 0;
+    lInt32 text_count = 0;
+
+    bool operator==(const LayoutCacheHeader& v) const
+    {
+        return version == v.version
+               && style_hash == v.style_hash
+               && stylesheet_hash == v.stylesheet_hash
+               && doc_flags == v.doc_flags
+               && width == v.width
+               && height == v.height
+               && y0 == v.y0
+               && interline_space == v.interline_space
+               && show_cover == v.show_cover
+               && elem_count == v.elem_count
+               && text_count == v.text_count;
+    }
+
+    void write(SerialBuf& buf)
+    {
+        buf << version << style_hash << stylesheet_hash << doc_flags;
+        buf << width << height << y0 << interline_space << show_cover;
+        buf << elem_count << text_count;
+    }
+
+    void read(SerialBuf& buf)
+    {
+        buf >> version >> style_hash >> stylesheet_hash >> doc_flags;
+        buf >> width >> height >> y0 >> interline_space >> show_cover;
+        buf >> elem_count >> text_count;
+    }
+};
+
+static LayoutCacheHeader MakeLayoutCacheHeader(CrDom* dom, lUInt32 style_hash, lUInt32 stylesheet_hash,
+        int width, int height, bool show_cover, int y0, int interline_space, int elem_count, int text_count)
+{
+    LayoutCacheHeader hdr;
+    hdr.style_hash = style_hash;
+    hdr.stylesheet_hash = stylesheet_hash;
+    hdr.doc_flags = dom->getDocFlags();
+    hdr.width = width;
+    hdr.height = height;
+    hdr.y0 = y0;
+    hdr.interline_space = interline_space;
+    hdr.show_cover = show_cover;
+    hdr.elem_count = elem_count;
+    hdr.text_count = text_count;
+    return hdr;
+}
+
+bool CrDom::loadLayoutCache(LVRendPageList* pages, int width, int dy, bool showCover, int y0,
+        int interline_space)
+{
+    if (_layoutCacheFile.empty())
+    {
+        return false;
+    }
+    LVStreamRef stream = LVMapFileStream(_layoutCacheFile.c_str(), LVOM_READ, 0);
+    if (stream.isNull())
+    {
+        return false;
+    }
+    int size = (int) stream->GetSize();
+    LVStreamBufferRef mapped = stream->GetReadBuffer(0, size);
+    if (mapped.isNull() || mapped->getReadOnly() == NULL)
+    {
+        return false;
+    }
+    SerialBuf buf(mapped->getReadOnly(), size);
+    // CRC of everything before it is stored at the end, checked before anything is applied
+    int crc_pos = size - (int) sizeof(lUInt32);
+    buf.setPos(crc_pos);
+    if (crc_pos <= 0 || !buf.checkCRC(crc_pos))
+    {
+        CRLog::error("loadLayoutCache: cache file %s CRC mismatch", _layoutCacheFile.c_str());
+        return false;
+    }
+    buf.reset();
+    if (!buf.checkMagic(LAYOUT_CACHE_MAGIC))
+    {
+        return false;
+    }
+    LayoutCacheHeader cached;
+    cached.read(buf);
+    LayoutCacheHeader current = MakeLayoutCacheHeader(this, calcStyleHashFull(), calcStylesheetHash(),
+            width, dy, showCover, y0, interline_space, _elemCount, _textCount);
+    if (buf.error() || !(cached == current))
+    {
+        CRLog::trace("loadLayoutCache: render context changed, cache is not used");
+        return false;
+    }
+    lvdomElementFormatRec rec;
+    // Getting the last item allocates all rect storage chunks, setter expects them to exist
+    _rectStorage.getRendRectData(_elemCount << 4, &rec);
+    for (int i = 1; i <= _elemCount && !buf.error(); i++)
+    {
+        lInt32 x, w, y, h;
+        buf >> x >> w >> y >> h;
+        rec.setX(x);
+        rec.setWidth(w);
+        rec.setY(y);
+        rec.setHeight(h);
+        _rectStorage.setRendRectData(i << 4, &rec);
+    }
+    if (buf.error() || !pages->deserialize(buf) || buf.pos() != crc_pos)
+    {
+        CRLog::error("loadLayoutCache: broken cache file %s", _layoutCacheFile.c_str());
+        pages->clear();
+        return false;
+    }
+    CRLog::info("loadLayoutCache: %d pages loaded", pages->length());
+    return true;
+}
+
+void CrDom::saveLayoutCache(LVRendPageList* pages, int width, int dy, bool showCover, int y0,
+        int interline_space)
+{
+    if (_layoutCacheFile.empty())
+    {
+        return;
+    }
+    SerialBuf buf((_elemCount + 1) * 16 + pages->length() * 16 + 64);
+    buf.putMagic(LAYOUT_CACHE_MAGIC);
+    LayoutCacheHeader hdr = MakeLayoutCacheHeader(this, calcStyleHashFull(), calcStylesheetHash(),
+            width, dy, showCover, y0, interline_space, _elemCount, _textCount);
+    hdr.write(buf);
+    lvdomElementFormatRec rec;
+    for (int i = 1; i <= _elemCount; i++)
+    {
+        _rectStorage.getRendRectData(i << 4, &rec);
+        buf << (lInt32) rec.getX() << (lInt32) rec.getWidth() << (lInt32) rec.getY() << (lInt32) rec.getHeight();
+    }
+    pages->serialize(buf);
+    buf.putCRC(buf.pos());
+    if (buf.error())
+    {
+        CRLog::error("saveLayoutCache: serialization failed");
+        return;
+    }
+    // Written to temporary file first, so broken cache is never seen by next open
+    lString8 tmp = _layoutCacheFile + ".tmp";
+    {
+        LVStreamRef stream = LVOpenFileStream(tmp.c_str(), LVOM_WRITE);
+        if (stream.isNull())
+        {
+            CRLog::error("saveLayoutCache: cannot create %s", tmp.c_str());
+            return;
+        }
+        lvsize_t written = 0;
+        if (stream->Write(buf.buf(), buf.pos(), &written) != LVERR_OK || written != (lvsize_t) buf.pos())
+        {
+            CRLog::error("saveLayoutCache: cannot write %s", tmp.c_str());
+            stream.Clear();
+            remove(tmp.c_str());
+            return;
+        }
+    }
+    if (rename(tmp.c_str(), _layoutCacheFile.c_str()) != 0)
+    {
+        CRLog::error("saveLayoutCache: cannot rename %s", tmp.c_str());
+        remove(tmp.c_str());
+    }
+}
@@ -359,11 +359,11 @@ public:
     }
 };
 
-void LVRendPageContext::split()
+void LVRendPageContext::split(LVRendPageList* pages, bool partial)
 {
-    if ( !page_list )
+    if ( !pages )
         return;
-    PageSplitState s(page_list, page_h);
+    PageSplitState s(pages, page_h);
 
     int lineCount = lines.length();
 
@@ -391,18 +391,33 @@ void LVRendPageContext::split()
                     s.EndFootNote();
                 }
             }
-            if ( !foundFootNote )
+            // Note body may be not rendered yet on partial split
+            if ( !foundFootNote && !partial )
                 line->flags = line->flags & ~RN_SPLIT_FOOT_LINK;
         }
     }
     s.Finalize();
 }
 
-void LVRendPageContext::Finalize()
+void LVRendPageContext::Finalize(bool keepLines)
+{
+    split(page_list, false);
+    if (!keepLines) {
+        lines.clear();
+        footNotes.clear();
+    }
+}
+
+void LVRendPageContext::SplitPartial(LVRendPageList* pages)
 {
-    split();
-    lines.clear();
-    footNotes.clear();
+    split(pages, true);
+}
+
+void LVRendPageContext::Resplit(LVRendPageList* pages, int pageHeight)
+{
+    page_list = pages;
+    page_h = pageHeight;
+    split(pages, false);
 }
 
 static const char * pagelist_magic = "PageList";
@@ -459,6 +474,13 @@ bool LVRendPageInfo::serialize( SerialBuf & buf )
         buf << (lUInt32)footnotes[i].start;
         buf << (lUInt32)footnotes[i].height;
     }
+    lUInt16 infoLen = footnotes_info.length();
+    buf << infoLen;
+    for ( int i=0; i<infoLen; i++ ) {
+        buf << (lUInt32)footnotes_info[i].start;
+        buf << (lUInt32)footnotes_info[i].height;
+        buf << footnotes_info[i].id;
+    }
     return !buf.error();
 }
 
@@ -489,6 +511,16 @@ bool LVRendPageInfo::deserialize( SerialBuf & buf )
             footnotes.add( LVPageFootNoteInfo( n1, n2 ) );
         }
     }
+    lUInt16 infoLen;
+    buf >> infoLen;
+    footnotes_info.clear();
+    for ( int i=0; i<infoLen && !buf.error(); i++ ) {
+        lUInt32 n1;
+        lUInt32 n2;
+        lString16 id;
+        buf >> n1 >> n2 >> id;
+        footnotes_info.add( FootNoteInfo( n1, n2, id ) );
+    }
     return !buf.error();
 }
 
@@ -1494,21 +1494,26 @@ void getPageBreakStyle( ldomNode * el, css_page_break_t &before, css_page_break_
     }
 }
 
+static bool isFootNoteBodyNode( ldomNode * enode )
+{
+    if ( enode->getNodeId()==el_section && enode->getCrDom()->getDocFlag(DOC_FLAG_ENABLE_FOOTNOTES) ) {
+        ldomNode * body = enode->getParentNode();
+        while ( body != NULL && body->getNodeId()!=el_body )
+            body = body->getParentNode();
+        if ( body ) {
+            if (body->getAttributeValue(attr_name) == "notes_hidden")// || body->getAttributeValue(attr_name) == "comments")
+                if ( !enode->getAttributeValue(attr_id).empty() )
+                    return true;
+        }
+    }
+    return false;
+}
+
 int renderBlockElement( LVRendPageContext & context, ldomNode * enode, int x, int y, int width )
 {
     if ( enode->isElement() )
     {
-        bool isFootNoteBody = false;
-        if ( enode->getNodeId()==el_section && enode->getCrDom()->getDocFlag(DOC_FLAG_ENABLE_FOOTNOTES) ) {
-            ldomNode * body = enode->getParentNode();
-            while ( body != NULL && body->getNodeId()!=el_body )
-                body = body->getParentNode();
-            if ( body ) {
-                if (body->getAttributeValue(attr_name) == "notes_hidden")// || body->getAttributeValue(attr_name) == "comments")
-                    if ( !enode->getAttributeValue(attr_id).empty() )
-                        isFootNoteBody = true;
-            }
-        }
+        bool isFootNoteBody = isFootNoteBodyNode( enode );
 //        if ( isFootNoteBody )
 //            CRLog::trace("renderBlockElement() : Footnote body detected! %s", LCSTR(ldomXPointer(enode,0).toString()) );
         //if (!fmt)
@@ -1605,6 +1610,8 @@ int renderBlockElement( LVRendPageContext & context, ldomNode * enode, int x, in
                     if ( isFootNoteBody )
                         context.enterFootNote( enode->getAttributeValue(attr_id) );
                     // render whole node content as single formatted object
+                    // TODO: format spine items in parallel here; LVFormatter is reentrant,
+                    // but refcounts, font glyph caches, rend block cache and node storage are not
                     fmt.setWidth( width );
                     fmt.setX( fmt.getX() );
                     fmt.setY( fmt.getY() );
@@ -1718,6 +1725,122 @@ int renderBlockElement( LVRendPageContext & context, ldomNode * enode, int x, in
     return 0;
 }
 
+// Children not reached yet are moved below any page, so stale rects are never drawn
+#define PROGRESSIVE_RENDER_FAR_Y 0x3FFFFFFF
+
+LVProgressiveRender::LVProgressiveRender( LVRendPageContext & context, ldomNode * root, int x, int y, int width )
+    : context_(context), root_(root), x_(x), y_(y), width_(width), height_(0), done_(false)
+{
+    if ( root_->isElement() && root_->getRendMethod()==erm_block )
+        push( root_, x_, y_, width_ );
+}
+
+void LVProgressiveRender::push( ldomNode * enode, int x, int y, int width )
+{
+    Frame f;
+    f.node = enode;
+    f.footnote = isFootNoteBodyNode( enode );
+    f.em = enode->getFont()->getSize();
+    int margin_left = lengthToPx( enode->getStyle()->margin[0], width, f.em ) + DEBUG_TREE_DRAW;
+    int margin_right = lengthToPx( enode->getStyle()->margin[1], width, f.em ) + DEBUG_TREE_DRAW;
+    f.margin_top = lengthToPx( enode->getStyle()->margin[2], width, f.em ) + DEBUG_TREE_DRAW;
+    f.margin_bottom = lengthToPx( enode->getStyle()->margin[3], width, f.em ) + DEBUG_TREE_DRAW;
+    f.padding_left = lengthToPx( enode->getStyle()->padding[0], width, f.em ) + DEBUG_TREE_DRAW;
+    int padding_right = lengthToPx( enode->getStyle()->padding[1], width, f.em ) + DEBUG_TREE_DRAW;
+    int padding_top = lengthToPx( enode->getStyle()->padding[2], width, f.em ) + DEBUG_TREE_DRAW;
+    f.padding_bottom = lengthToPx( enode->getStyle()->padding[3], width, f.em ) + DEBUG_TREE_DRAW;
+    if (margin_left>0)
+        x += margin_left;
+    y += f.margin_top;
+    width -= margin_left + margin_right;
+    {
+        RenderRectAccessor fmt( enode );
+        fmt.setX( x );
+        fmt.setY( y );
+        fmt.setWidth( width );
+        fmt.setHeight( 0 );
+        fmt.push();
+    }
+    if ( f.footnote )
+        context_.enterFootNote( enode->getAttributeValue(attr_id) );
+    f.inner_width = width - f.padding_left - padding_right;
+    f.y = padding_top;
+    f.child = 0;
+    f.count = enode->getChildCount();
+    for ( int i=0; i<f.count; i++ ) {
+        ldomNode * child = enode->getChildNode( i );
+        if ( !child->isElement() )
+            continue;
+        RenderRectAccessor fmt( child );
+        fmt.setY( PROGRESSIVE_RENDER_FAR_Y );
+        fmt.setHeight( 0 );
+    }
+    stack_.add( f );
+}
+
+int LVProgressiveRender::pop()
+{
+    Frame f = stack_.remove( stack_.length() - 1 );
+    int y = f.y;
+    int st_y = lengthToPx( f.node->getStyle()->height, f.em, f.em );
+    if ( y < st_y )
+        y = st_y;
+    {
+        RenderRectAccessor fmt( f.node );
+        fmt.setHeight( y + f.padding_bottom );
+    }
+    if ( f.footnote )
+        context_.leaveFootNote();
+    return y + f.margin_top + f.margin_bottom + f.padding_bottom;
+}
+
+bool LVProgressiveRender::Step( int maxFinalBlocks )
+{
+    if ( done_ )
+        return true;
+    if ( stack_.empty() ) {
+        // root is not a block container, nothing to split in steps
+        height_ = renderBlockElement( context_, root_, x_, y_, width_ );
+        done_ = true;
+        return true;
+    }
+    int target = context_.getRenderedFinalBlocks() + maxFinalBlocks;
+    while ( !stack_.empty() && context_.getRenderedFinalBlocks() < target ) {
+        Frame & f = stack_[stack_.length() - 1];
+        if ( f.child >= f.count ) {
+            int h = pop();
+            if ( stack_.empty() ) {
+                height_ = h;
+                done_ = true;
+                return true;
+            }
+            Frame & parent = stack_[stack_.length() - 1];
+            parent.y += h;
+            parent.child++;
+            continue;
+        }
+        ldomNode * child = f.node->getChildNode( f.child );
+        if ( child->isElement() && child->getRendMethod()==erm_block ) {
+            int x = f.padding_left;
+            int y = f.y;
+            int width = f.inner_width;
+            // f is invalidated by push
+            push( child, x, y, width );
+            continue;
+        }
+        f.y += renderBlockElement( context_, child, f.padding_left, f.y, f.inner_width );
+        f.child++;
+    }
+    // Open blocks get height of their rendered part, so rendered pages can be drawn
+    for ( int i=0; i<stack_.length(); i++ ) {
+        RenderRectAccessor fmt( stack_[i].node );
+        fmt.setHeight( stack_[i].y );
+    }
+    Frame & root = stack_[0];
+    height_ = root.y + root.margin_top;
+    return false;
+}
+
 void DrawDocument( LVDrawBuf & drawbuf, ldomNode * enode, int x0, int y0, int dx, int dy, int doc_x, int doc_y, int page_height, ldomMarkedRangeList * marks,
                    ldomMarkedRangeList *bookmarks, lvRect margins,int columns)
 {
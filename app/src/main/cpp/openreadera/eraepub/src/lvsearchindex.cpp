@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#include <algorithm>
+
+#include "include/lvsearchindex.h"
+#include "include/charProps.h"
+
+static bool IsUnusualSpace(lChar16 ch)
+{
+    return (ch == L'\u00A0')
+           || (ch == L'\u180E')
+           || ((ch >= L'\u2000') && (ch <= L'\u200B'))
+           || (ch == L'\u202F')
+           || (ch == L'\u205F')
+           || (ch == L'\u3000')
+           || (ch == L'\uFEFF');
+}
+
+void LVSearchIndex::Tokenize(const lString16 &text, LVArray<lString16> &tokens)
+{
+    // Same splitting as AddtoAllPunctuation + ReplaceUnusualSpaces + parse by space,
+    // but in a single pass
+    int word_flags = CH_PROP_ALPHA | CH_PROP_HIEROGLYPH;
+    int start = -1;
+    for (int i = 0; i <= text.length(); i++)
+    {
+        lChar16 ch = i < text.length() ? text[i] : 0;
+        bool word_char = ch != 0 && ch != L'\n' && !IsUnusualSpace(ch)
+                         && (lGetCharProps(ch) & word_flags);
+        if (word_char)
+        {
+            if (start < 0)
+            {
+                start = i;
+            }
+            continue;
+        }
+        if (start >= 0)
+        {
+            tokens.add(text.substr(start, i - start));
+            start = -1;
+        }
+        if (ch == 0 || ch == L' ' || IsUnusualSpace(ch))
+        {
+            continue;
+        }
+        tokens.add(lString16(&ch, 1));
+    }
+}
+
+bool LVSearchIndex::IsPunctuation(const lString16 &token)
+{
+    if (token.length() != 1)
+    {
+        return false;
+    }
+    int flags = CH_PROP_ALPHA | CH_PROP_SPACE | CH_PROP_HIEROGLYPH;
+    return !(lGetCharProps(token[0]) & flags);
+}
+
+void LVSearchIndex::AddPhrase(lString16Map &map, const std::string &phrase)
+{
+    map[phrase]++;
+}
+
+void LVSearchIndex::Reset(int pages_count)
+{
+    indexed_.assign(pages_count, false);
+    phrases_.assign(pages_count, lString16Map());
+    first_terms_.assign(pages_count, std::string());
+    last_terms_.assign(pages_count, std::string());
+    terms_.clear();
+    indexed_count_ = 0;
+    cached_query_.clear();
+    cached_pages_.clear();
+}
+
+bool LVSearchIndex::IsIndexed(int page) const
+{
+    return page >= 0 && page < (int) indexed_.size() && indexed_[page];
+}
+
+void LVSearchIndex::AddPage(int page, const lString16 &text)
+{
+    if (page < 0 || page >= (int) indexed_.size() || indexed_[page])
+    {
+        return;
+    }
+    lString16 lower = text;
+    lower.lowercase();
+    LVArray<lString16> tokens;
+    Tokenize(lower, tokens);
+
+    std::vector<std::string> utf8;
+    std::vector<bool> punct;
+    utf8.reserve(tokens.length());
+    punct.reserve(tokens.length());
+    for (int i = 0; i < tokens.length(); i++)
+    {
+        utf8.push_back(std::string(UnicodeToUtf8(tokens[i]).c_str()));
+        punct.push_back(IsPunctuation(tokens[i]));
+        terms_[utf8.back()].push_back(LVSearchPosting{ page, i });
+    }
+    if (!utf8.empty())
+    {
+        first_terms_[page] = utf8.front();
+        last_terms_[page] = utf8.back();
+    }
+
+    // Words and 2-3 word phrases, as LVDocView::GetPhrasesIndexesMapForPage always did
+    lString16Map &phrases = phrases_[page];
+    int count = (int) tokens.length();
+    for (int i = 0; i < count; i++)
+    {
+        if (tokens[i].length() < 3 || punct[i])
+        {
+            continue;
+        }
+        AddPhrase(phrases, utf8[i]);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        for (int n = 2; n <= 3; n++)
+        {
+            int end = std::min(i + n, count);
+            bool has_punct = false;
+            for (int j = i; j < end; j++)
+            {
+                has_punct = has_punct || punct[j];
+            }
+            if (has_punct || tokens[i].length() < 3 || tokens[end - 1].length() < 3)
+            {
+                continue;
+            }
+            std::string phrase = utf8[i];
+            for (int j = i + 1; j < end; j++)
+            {
+                phrase += " ";
+                phrase += utf8[j];
+            }
+            AddPhrase(phrases, phrase);
+        }
+    }
+    indexed_[page] = true;
+    indexed_count_++;
+    cached_query_.clear();
+}
+
+const lString16Map &LVSearchIndex::GetPagePhrases(int page) const
+{
+    return phrases_.at(page);
+}
+
+const std::vector<bool> &LVSearchIndex::FindCandidatePages(const lString16 &query)
+{
+    lString16 lower = query;
+    lower.lowercase();
+    std::string key(UnicodeToUtf8(lower).c_str());
+    if (!cached_query_.empty() && cached_query_ == key)
+    {
+        return cached_pages_;
+    }
+    int pages_count = (int) indexed_.size();
+    LVArray<lString16> tokens;
+    Tokenize(lower, tokens);
+    if (tokens.empty())
+    {
+        cached_pages_.assign(pages_count, true);
+        cached_query_ = key;
+        return cached_pages_;
+    }
+    // Pages not indexed yet may contain anything
+    std::vector<bool> found(pages_count);
+    for (int p = 0; p < pages_count; p++)
+    {
+        found[p] = !indexed_[p];
+    }
+    for (int t = 0; t < tokens.length(); t++)
+    {
+        std::string token(UnicodeToUtf8(tokens[t]).c_str());
+        for (auto it = terms_.begin(); it != terms_.end(); ++it)
+        {
+            if (it->first.find(token) == std::string::npos)
+            {
+                continue;
+            }
+            for (const LVSearchPosting &posting : it->second)
+            {
+                found[posting.page] = true;
+            }
+        }
+        for (int p = 0; p + 1 < pages_count; p++)
+        {
+            if (!found[p] && (last_terms_[p] + first_terms_[p + 1]).find(token) != std::string::npos)
+            {
+                found[p] = true;
+            }
+        }
+    }
+    cached_pages_.assign(pages_count, false);
+    for (int p = 0; p < pages_count; p++)
+    {
+        cached_pages_[p] = found[p] || (p + 1 < pages_count && found[p + 1]);
+    }
+    cached_query_ = key;
+    return cached_pages_;
+}
@@ -331,12 +331,12 @@ public:
             }
             m_staticBufs = false;
         } else {
-            // static buffer space
-            static lChar16 m_static_text[STATIC_BUFS_SIZE];
-            static lUInt8 m_static_flags[STATIC_BUFS_SIZE];
-            static src_text_fragment_t * m_static_srcs[STATIC_BUFS_SIZE];
-            static lUInt16 m_static_charindex[STATIC_BUFS_SIZE];
-            static int m_static_widths[STATIC_BUFS_SIZE];
+            // static buffer space, per thread to keep formatter reentrant
+            static thread_local lChar16 m_static_text[STATIC_BUFS_SIZE];
+            static thread_local lUInt8 m_static_flags[STATIC_BUFS_SIZE];
+            static thread_local src_text_fragment_t * m_static_srcs[STATIC_BUFS_SIZE];
+            static thread_local lUInt16 m_static_charindex[STATIC_BUFS_SIZE];
+            static thread_local int m_static_widths[STATIC_BUFS_SIZE];
             m_text = m_static_text;
             m_flags = m_static_flags;
             m_charindex = m_static_charindex;
@@ -413,6 +413,42 @@ public:
         resizeImage( width, height, maxw, maxh, arbitraryImageScaling, maxScale );
     }
 
+    /// resizes object for current page height, narrows range of page heights giving the same size
+    void resizeObject( int & width, int & height, int maxw, bool isInline )
+    {
+        int src_w = width;
+        int src_h = height;
+        int page_h = m_pbuffer->page_height;
+        resizeImage( width, height, maxw, page_h, isInline );
+        // Object size never decreases with page height, so heights giving this size form a range
+        int lo = m_pbuffer->page_height_min;
+        int hi = page_h;
+        while ( lo < hi ) {
+            int mid = (lo + hi) / 2;
+            int w = src_w;
+            int h = src_h;
+            resizeImage( w, h, maxw, mid, isInline );
+            if ( w==width && h==height )
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        m_pbuffer->page_height_min = (lUInt16)lo;
+        lo = page_h;
+        hi = m_pbuffer->page_height_max;
+        while ( lo < hi ) {
+            int mid = (lo + hi + 1) / 2;
+            int w = src_w;
+            int h = src_h;
+            resizeImage( w, h, maxw, mid, isInline );
+            if ( w==width && h==height )
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        m_pbuffer->page_height_max = (lUInt16)hi;
+    }
+
     void resizeImage( int & width, int & height, int maxw, int maxh, bool arbitraryImageScaling, int maxScaleMult )
     {
         //CRLog::trace("Resize image (%dx%d) max %dx%d %s  *%d", width, height, maxw, maxh, arbitraryImageScaling ? "arbitrary" : "integer", maxScaleMult);
@@ -492,8 +528,8 @@ public:
         int start = 0;
         int lastWidth = 0;
 #define MAX_TEXT_CHUNK_SIZE 4096
-        static lUInt16 widths[MAX_TEXT_CHUNK_SIZE+1];
-        static lUInt8 flags[MAX_TEXT_CHUNK_SIZE+1];
+        static thread_local lUInt16 widths[MAX_TEXT_CHUNK_SIZE+1];
+        static thread_local lUInt8 flags[MAX_TEXT_CHUNK_SIZE+1];
         int tabIndex = -1;
         for ( i=0; i<=m_length; i++ ) {
             LVFont * newFont = NULL;
@@ -560,7 +596,7 @@ public:
                     // assume i==start+1
                     int width = m_srcs[start]->o.width;
                     int height = m_srcs[start]->o.height;
-                    resizeImage(width, height, m_pbuffer->width, m_pbuffer->page_height, m_length>1);
+                    resizeObject(width, height, m_pbuffer->width, m_length>1);
                     lastWidth += width;
                     m_widths[start] = lastWidth;
                 }
@@ -749,7 +785,7 @@ public:
 
                     int width = lastSrc->o.width;
                     int height = lastSrc->o.height;
-                    resizeImage(width, height, m_pbuffer->width - x, m_pbuffer->page_height, m_length>1);
+                    resizeObject(width, height, m_pbuffer->width - x, m_length>1);
                     word->width = width;
                     word->o.height = height;
 
@@ -1071,7 +1107,7 @@ public:
                     if ( len > MAX_WORD_SIZE )
                         len = MAX_WORD_SIZE;
                     lUInt8 * flags = m_flags + start;
-                    static lUInt16 widths[MAX_WORD_SIZE];
+                    static thread_local lUInt16 widths[MAX_WORD_SIZE];
                     int wordStart_w = start>0 ? m_widths[start-1] : 0;
                     for ( int i=0; i<len; i++ ) {
                         widths[i] = m_widths[start+i] - wordStart_w;
@@ -1227,6 +1263,8 @@ lUInt32 LFormattedText::Format(lUInt16 width, lUInt16 page_height)
     m_pbuffer->width = width;
     m_pbuffer->height = 0;
     m_pbuffer->page_height = page_height;
+    m_pbuffer->page_height_min = 1;
+    m_pbuffer->page_height_max = 0xFFFF;
     // format text
     LVFormatter formatter( m_pbuffer );
 
@@ -1460,7 +1498,7 @@ void LFormattedText::Draw( LVDrawBuf * buf, int x, int y, ldomMarkedRangeList *
                 {
                     srcline = &m_pbuffer->srctext[word->src_text_index];
                     ldomNode * node = (ldomNode *) srcline->object;
-                    LVImageSourceRef img = node->getObjectImageSource();
+                    LVImageSourceRef img = node->getScaledObjectImageSource( word->width, word->o.height );
                     if ( img.isNull() )
                         img = LVCreateDummyImageSource( node, word->width, word->o.height );
                     int xx = x + frmline->x + word->x;
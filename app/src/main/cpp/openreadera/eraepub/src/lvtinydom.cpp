@@ -11,6 +11,7 @@
    See LICENSE file for details
 *******************************************************/
 
+#include <climits>
 #include <map>
 #include <stdlib.h>
 #include <zlib.h>
@@ -1286,6 +1287,7 @@ CrDomXml::CrDomXml()
 		  _attrValueTable( DOC_STRING_HASH_SIZE ),
 		  _idNodeMap(8192),
 		  _urlImageMap(1024),
+		  _scaledImageCache(SCALED_IMAGE_CACHE_SIZE),
 		  _idAttrId(0),
 		  _nameAttrId(0),
 		  //_keepData(false),
@@ -1402,6 +1404,12 @@ CrDom::CrDom()
 , _page_width(0)
 , _rendered(false)
 , lists(100)
+, _progressive(NULL)
+, _splitContext(NULL)
+, _splitY0(0)
+, _splitShowCover(false)
+, _layoutPageHeightMin(1)
+, _layoutPageHeightMax(0xFFFF)
 {
     allocTinyElement(NULL, 0, 0);
     //new ldomElement( this, NULL, 0, 0, 0 );
@@ -1489,6 +1497,8 @@ bool CrDom::saveToStream(LVStreamRef stream, const char *, bool treeLayout)
 
 CrDom::~CrDom()
 {
+    dropProgressiveRender();
+    resetSplitContext();
 	stylesheet_.clear();
     fontMan->UnregisterDocumentFonts(_docIndex);
 }
@@ -1766,14 +1776,18 @@ bool CrDom::parseStyleSheet(lString16 cssFile)
     return parser.Parse(cssFile);
 }
 
+lUInt32 CrDom::calcStylesheetHash()
+{
+    return ((stylesheet_.getHash() * 31) + calcHash(_def_style)) * 31 + calcHash(_def_font);
+}
+
 /// save document formatting parameters after render
 void CrDom::updateRenderContext()
 {
     int dx = _page_width;
     int dy = _page_height;
     lUInt32 styleHash = calcStyleHash();
-    lUInt32 stylesheetHash = (((stylesheet_.getHash() * 31) + calcHash(_def_style))
-                              * 31 + calcHash(_def_font));
+    lUInt32 stylesheetHash = calcStylesheetHash();
     //calcStyleHash( getRootNode(), styleHash );
     _hdr.render_style_hash = styleHash;
     _hdr.stylesheet_hash = stylesheetHash;
@@ -1802,8 +1816,7 @@ bool CrDom::checkRenderContext()
         res = false;
     }
     lUInt32 styleHash = calcStyleHash();
-    lUInt32 stylesheetHash = (((stylesheet_.getHash() * 31) + calcHash(_def_style)) * 31
-                              + calcHash(_def_font));
+    lUInt32 stylesheetHash = calcStylesheetHash();
     //calcStyleHash( getRootNode(), styleHash );
     if ( styleHash != _hdr.render_style_hash ) {
         CRLog::trace("checkRenderContext: Style hash doesn't match %x!=%x",
@@ -1829,16 +1842,88 @@ bool CrDom::checkRenderContext()
     return res;
 }
 
+/// render state kept between steps of progressive render
+struct ProgressiveRenderState
+{
+    LVRendPageList* pages;
+    int width;
+    int dy;
+    bool show_cover;
+    int y0;
+    int interline_space;
+    LVRendPageContext* context;
+    LVProgressiveRender render;
+
+    ProgressiveRenderState(CrDom* dom, LVRendPageContext* pageContext, LVRendPageList* pageList,
+            int w, int h, bool cover, int top, int interline, int finalBlocks)
+            : pages(pageList), width(w), dy(h), show_cover(cover), y0(top),
+              interline_space(interline), context(pageContext),
+              render(*pageContext, dom->getRootNode(), 0, top, w)
+    {
+        context->setCallback(finalBlocks);
+    }
+
+    ~ProgressiveRenderState()
+    {
+        delete context;
+    }
+};
+
+bool CrDom::checkStyleContext()
+{
+    ldomNode* node = getRootNode();
+    if (node != NULL && node->getFont().isNull()) {
+        return false;
+    }
+    return calcStyleHash() == _hdr.render_style_hash
+            && calcStylesheetHash() == _hdr.stylesheet_hash
+            && _docFlags == _hdr.render_docflags;
+}
+
+void CrDom::resetSplitContext()
+{
+    delete _splitContext;
+    _splitContext = NULL;
+    _layoutPageHeightMin = 1;
+    _layoutPageHeightMax = 0xFFFF;
+}
+
+bool CrDom::resplitPages(LVRendPageList* pages, int width, int dy, bool showCover, int y0,
+        int interline_space)
+{
+    // Element rects are kept only if page height doesn't change formatting and positions
+    if (!_rendered || _splitContext == NULL
+            || _page_width != (int) _hdr.render_dx
+            || showCover != _splitShowCover || y0 != _splitY0
+            || dy < _layoutPageHeightMin || dy > _layoutPageHeightMax) {
+        return false;
+    }
+    CRLog::trace("CrDom::render page height changed %d -> %d, splitting pages only",
+            (int) _hdr.render_dy, dy);
+    pages->clear();
+    if (showCover) {
+        pages->add(new LVRendPageInfo(_page_height));
+    }
+    _splitContext->Resplit(pages, _page_height);
+    updateRenderContext();
+    _pagesData.reset();
+    pages->serialize(_pagesData);
+    saveLayoutCache(pages, width, dy, showCover, y0, interline_space);
+    return true;
+}
+
 int CrDom::render(LVRendPageList* pages,
         int width,
         int dy,
 		bool showCover,
 		int y0,
 		font_ref_t def_font,
-		int interline_space)
+		int interline_space,
+		int firstBlocks)
 {
     CRLog::info("CrDom::render w=%d, h=%d, fontFace=%s, docFlags=%d",
     		width, dy, def_font->getTypeFace().c_str(), getDocFlags());
+    dropProgressiveRender();
     setRenderProps(width, dy, def_font, interline_space);
     // update styles
     //if (getRootNode()->getStyle().isNull() || getRootNode()->getFont().isNull()
@@ -1854,20 +1939,27 @@ int CrDom::render(LVRendPageList* pages,
     this->ApplyEmbeddedStyles();
 
     if (!checkRenderContext()) {
-        //CRLog::info("CrDom::checkRenderContext FORMATTING");
-        dropStyles();
-        //CRLog::trace("stylesheet_.push()");
-
-        stylesheet_.push();
-        applyDocStylesheet();
-        //CRLog::info("initNodeStyleRecursive()");
-        getRootNode()->initNodeStyleRecursive();
-        //CRLog::trace("stylesheet_.pop()");
-        stylesheet_.pop();
-        //CRLog::trace("Init render method");
-        getRootNode()->initNodeRendMethodRecursive();
-        //getRootNode()->setFont(_def_font);
-        //getRootNode()->setStyle(_def_style);
+        if (checkStyleContext()) {
+            // Only page size is changed, styles and render methods are still valid
+            if (resplitPages(pages, width, dy, showCover, y0, interline_space)) {
+                return getFullHeight();
+            }
+        } else {
+            //CRLog::info("CrDom::checkRenderContext FORMATTING");
+            dropStyles();
+            //CRLog::trace("stylesheet_.push()");
+
+            stylesheet_.push();
+            applyDocStylesheet();
+            //CRLog::info("initNodeStyleRecursive()");
+            getRootNode()->initNodeStyleRecursive();
+            //CRLog::trace("stylesheet_.pop()");
+            stylesheet_.pop();
+            //CRLog::trace("Init render method");
+            getRootNode()->initNodeRendMethodRecursive();
+            //getRootNode()->setFont(_def_font);
+            //getRootNode()->setStyle(_def_style);
+        }
         updateRenderContext();
         //lUInt32 styleHash = calcStyleHash();
         //styleHash = styleHash * 31 + calcGlobalSettingsHash();
@@ -1875,21 +1967,45 @@ int CrDom::render(LVRendPageList* pages,
     }
     if (!_rendered) {
         pages->clear();
+        resetSplitContext();
+        if (loadLayoutCache(pages, width, dy, showCover, y0, interline_space)) {
+            _rendered = true;
+            updateRenderContext();
+            _pagesData.reset();
+            pages->serialize( _pagesData );
+            return getFullHeight();
+        }
         if (showCover) {
         	pages->add(new LVRendPageInfo(_page_height));
         }
-        LVRendPageContext context(pages, _page_height);
+        if (firstBlocks > 0) {
+            _progressive = new ProgressiveRenderState(this, new LVRendPageContext(pages, _page_height),
+                    pages, width, dy, showCover, y0, interline_space, calcFinalBlocks());
+            // Rendered part should fill at least one page
+            while (!continueRender(firstBlocks)) {
+                updateProgressivePages();
+                if (pages->length() > (showCover ? 1 : 0)) {
+                    return _progressive->render.GetHeight() + y0;
+                }
+            }
+            return getFullHeight();
+        }
+        LVRendPageContext* context = new LVRendPageContext(pages, _page_height);
         int numFinalBlocks = calcFinalBlocks();
         CRLog::trace("Final block count: %d", numFinalBlocks);
         //updateStyles();
-        int height = renderBlockElement( context, getRootNode(), 0, y0, width ) + y0;
+        int height = renderBlockElement( *context, getRootNode(), 0, y0, width ) + y0;
         _rendered = true;
         gc();
         //CRLog::trace("finalizing... fonts.length=%d", _fonts.length());
-        context.Finalize();
+        context->Finalize(true);
+        _splitContext = context;
+        _splitY0 = y0;
+        _splitShowCover = showCover;
         updateRenderContext();
         _pagesData.reset();
         pages->serialize( _pagesData );
+        saveLayoutCache(pages, width, dy, showCover, y0, interline_space);
         return height;
     } else {
         CRLog::trace("rendering context is not changed, no render");
@@ -1902,6 +2018,82 @@ int CrDom::render(LVRendPageList* pages,
     }
 }
 
+bool CrDom::continueRender(int maxBlocks)
+{
+    if (_progressive == NULL) {
+        return true;
+    }
+    if (!_progressive->render.Step(maxBlocks > 0 ? maxBlocks : INT_MAX)) {
+        return false;
+    }
+    finishProgressiveRender();
+    return true;
+}
+
+int CrDom::finishProgressiveRender()
+{
+    ProgressiveRenderState* state = _progressive;
+    LVRendPageList* pages = state->pages;
+    int height = state->render.GetHeight() + state->y0;
+    // Pages of rendered part were added to the same list by updateProgressivePages
+    pages->clear();
+    if (state->show_cover) {
+        pages->add(new LVRendPageInfo(_page_height));
+    }
+    _rendered = true;
+    gc();
+    state->context->Finalize(true);
+    _splitContext = state->context;
+    _splitY0 = state->y0;
+    _splitShowCover = state->show_cover;
+    state->context = NULL;
+    updateRenderContext();
+    _pagesData.reset();
+    pages->serialize(_pagesData);
+    saveLayoutCache(pages, state->width, state->dy, state->show_cover, state->y0,
+            state->interline_space);
+    _progressive = NULL;
+    delete state;
+    CRLog::trace("progressive render finished, %d pages", pages->length());
+    return height;
+}
+
+void CrDom::updateProgressivePages()
+{
+    if (_progressive == NULL) {
+        return;
+    }
+    LVRendPageList* pages = _progressive->pages;
+    pages->clear();
+    if (_progressive->show_cover) {
+        pages->add(new LVRendPageInfo(_page_height));
+    }
+    _progressive->context->SplitPartial(pages);
+    // Last page may get more lines with next render step
+    if (pages->length() > (_progressive->show_cover ? 1 : 0)) {
+        pages->erase(pages->length() - 1, 1);
+    }
+}
+
+int CrDom::getRenderProgress()
+{
+    if (_progressive == NULL) {
+        return 100;
+    }
+    int total = _progressive->context->getTotalFinalBlocks();
+    if (total <= 0) {
+        return 0;
+    }
+    int percent = _progressive->context->getRenderedFinalBlocks() * 100 / total;
+    return percent < 100 ? percent : 99;
+}
+
+void CrDom::dropProgressiveRender()
+{
+    delete _progressive;
+    _progressive = NULL;
+}
+
 void CrDomXml::setNodeTypes( const elem_def_t * node_scheme )
 {
     if (!node_scheme)
@@ -7071,6 +7263,7 @@ void CrDom::clear()
     clearRendBlockCache();
     _rendered = false;
     _urlImageMap.clear();
+    _scaledImageCache.clear();
     _fontList.clear();
     fontMan->UnregisterDocumentFonts(_docIndex);
     //TODO: implement clear
@@ -9386,6 +9579,24 @@ LVImageSourceRef ldomNode::getObjectImageSource()
     return ref;
 }
 
+LVImageSourceRef ldomNode::getScaledObjectImageSource( int dx, int dy )
+{
+    lString16 refName = getObjectImageRefName();
+    if (refName.empty())
+        return LVImageSourceRef();
+    LVScaledImageCache & cache = getCrDom()->_scaledImageCache;
+    LVImageSourceRef ref = cache.get(refName, dx, dy);
+    if (!ref.isNull())
+        return ref;
+    // decode with real decoder, no need in proxy for cached copy
+    ref = getCrDom()->getObjectImageSource(refName);
+    if (ref.isNull()) {
+        CRLog::warn("ObjectImageSource cannot be opened by name:%s", LCSTR(refName));
+        return ref;
+    }
+    return cache.put(refName, ref, dx, dy);
+}
+
 /// register embedded document fonts in font manager, if any exist in document
 void CrDom::registerEmbeddedFonts()
 {
@@ -9564,6 +9775,10 @@ int ldomNode::renderFinalBlock(  LFormattedTextRef & frmtext, RenderRectAccessor
     int page_h = getCrDom()->getPageHeight();
     cache.set( this, f );
     int h = f->Format((lUInt16)width, (lUInt16)page_h);
+    int min_page_h;
+    int max_page_h;
+    f->GetPageHeightRange(min_page_h, max_page_h);
+    getCrDom()->limitLayoutPageHeight(min_page_h, max_page_h);
     frmtext = f;
     //CRLog::trace("Created new formatted object for node #%08X", (lUInt32)this);
     return h;
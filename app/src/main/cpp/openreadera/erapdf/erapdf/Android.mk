@@ -31,6 +31,8 @@ LOCAL_SRC_FILES := \
 	MuPdfText.cpp \
 	MuPdfConfig.cpp \
 	MuPdfSearch.cpp \
+	MuPdfRender.cpp \
+	MuPdfTextIndex.cpp \
 	EraPdfReflow.cpp \
 	EraPdfReflowText.cpp
 
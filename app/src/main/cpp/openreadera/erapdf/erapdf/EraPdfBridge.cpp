@@ -42,9 +42,9 @@ MuPdfBridge::MuPdfBridge() : StBridge("EraPdfBridge")
     pageCount = 0;
     pages = nullptr;
     pageLists = nullptr;
+    pageLayered = nullptr;
     storememory = 64 * 1024 * 1024;
     format = 0;
-    layersmask = -1;
     resetFonts();
     reflowManager = nullptr;
 }
@@ -85,6 +85,18 @@ void MuPdfBridge::process(CmdRequest& request, CmdResponse& response)
     case CMD_REQ_PAGE_FREE:
         processPageFree(request, response);
         break;
+    case CMD_REQ_RENDER_BUFFER:
+        processRenderBuffer(request, response);
+        break;
+    case CMD_REQ_PAGE_TILE:
+        processPageTile(request, response);
+        break;
+    case CMD_REQ_TILE_CACHE:
+        processTileCache(request, response);
+        break;
+    case CMD_REQ_PREFETCH:
+        processPrefetch(request, response);
+        break;
     case CMD_REQ_PAGE_TEXT:
         processPageText(request, response);
         break;
@@ -106,6 +118,12 @@ void MuPdfBridge::process(CmdRequest& request, CmdResponse& response)
     case CMD_REQ_PDF_STORAGE:
         processStorage(request, response);
         break;
+    case CMD_REQ_PDF_MEMORY:
+        processMemory(request, response);
+        break;
+    case CMD_REQ_PDF_TRIM_MEMORY:
+        processTrimMemory(request, response);
+        break;
     case CMD_REQ_PDF_SET_LAYERS_MASK:
         processSetLayersMask(request, response);
         break;
@@ -125,6 +143,7 @@ void MuPdfBridge::process(CmdRequest& request, CmdResponse& response)
         processXPathByRectId(request, response);
         break;
     case CMD_REQ_SEARCH_PREVIEWS:
+    case CMD_REQ_SEARCH_STREAM:
         processTextSearchPreviews(request, response);
         break;
     case CMD_REQ_SEARCH_HITBOXES:
@@ -133,6 +152,9 @@ void MuPdfBridge::process(CmdRequest& request, CmdResponse& response)
     case CMD_REQ_SEARCH_COUNTER:
         processSearchCounter(request, response);
         break;
+    case CMD_REQ_TEXT_INDEX:
+        processTextIndex(request, response);
+        break;
     case CMD_REQ_RANGE_HITBOX:
         processPageRangeText(request, response);
         break;
@@ -158,11 +180,7 @@ void MuPdfBridge::process(CmdRequest& request, CmdResponse& response)
 
 void MuPdfBridge::processQuit(CmdRequest& request, CmdResponse& response)
 {
-    for (int i = 0; i < pagesCache.size(); i++)
-    {
-        pagesCache.at(i).reset();
-    }
-    pagesCache.clear();
+    saveTextIndex();
     for (int i = 0; i < pageCount; i++)
     {
         free(ctx->darkmode_objs[i].obj);
@@ -194,6 +212,136 @@ void MuPdfBridge::processStorage(CmdRequest& request, CmdResponse& response)
     LI("Storage size : %d MB", storageSize);
 }
 
+void MuPdfBridge::processMemory(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_PDF_MEMORY;
+    if (request.dataCount > 0)
+    {
+        uint32_t lists = 0;
+        uint32_t images = 0;
+        uint32_t glyphs = 0;
+        uint32_t fonts = 0;
+        CmdDataIterator iter(request.first);
+        if (!iter.getInt(&lists).getInt(&images).getInt(&glyphs).getInt(&fonts).isValid())
+        {
+            LE("Bad request data");
+            response.result = RES_BAD_REQ_DATA;
+            return;
+        }
+        listsMemory = lists;
+        imagesMemory = images;
+        glyphsMemory = glyphs;
+        fontsMemory = fonts;
+        applyMemoryBudgets();
+        if (listsMemory != 0)
+        {
+            trimPageLists(listsMemory, currentPage);
+        }
+    }
+    uint32_t lists = pageListsSize();
+    uint32_t images = ctx ? fz_store_used(ctx, FZ_STORE_IMAGE) : 0;
+    uint32_t glyphs = ctx ? (uint32_t) fz_glyph_cache_used(ctx) : 0;
+    uint32_t fonts = ctx ? fz_store_used(ctx, FZ_STORE_FONT) : 0;
+    uint32_t store = ctx ? fz_store_used(ctx, -1) : 0;
+    LD("Memory: lists %u of %u images %u of %u glyphs %u of %u fonts %u of %u store %u of %d",
+            lists, listsMemory, images, imagesMemory, glyphs, glyphsMemory, fonts, fontsMemory,
+            store, storememory);
+    response.addInt(lists);
+    response.addInt(listsMemory);
+    response.addInt(images);
+    response.addInt(imagesMemory);
+    response.addInt(glyphs);
+    response.addInt(glyphsMemory);
+    response.addInt(fonts);
+    response.addInt(fontsMemory);
+    response.addInt(store);
+    response.addInt((uint32_t) storememory);
+}
+
+void MuPdfBridge::processTrimMemory(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_PDF_TRIM_MEMORY;
+    uint32_t limit = 0;
+    if (!CmdDataIterator(request.first).getInt(&limit).isValid())
+    {
+        LE("Bad request data");
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    if (ctx == nullptr)
+    {
+        response.addInt(0);
+        return;
+    }
+    uint32_t max = limit < 4096 ? limit * 1024 * 1024 : UINT32_MAX;
+    uint32_t store = fz_store_used(ctx, -1);
+    uint32_t glyphs = (uint32_t) fz_glyph_cache_used(ctx);
+    // Display lists are the cheapest to rebuild, far pages go first
+    uint32_t others = store + glyphs;
+    uint32_t lists = trimPageLists(max > others ? max - others : 0, currentPage);
+    if (lists + store + glyphs > max)
+    {
+        fz_trim_store(ctx, max > lists + glyphs ? max - lists - glyphs : 0);
+        store = fz_store_used(ctx, -1);
+    }
+    if (lists + store + glyphs > max)
+    {
+        fz_purge_glyph_cache(ctx);
+        glyphs = 0;
+    }
+    LI("Memory trimmed to %u MB: lists %u store %u glyphs %u", limit, lists, store, glyphs);
+    response.addInt(lists + store + glyphs);
+}
+
+void MuPdfBridge::applyMemoryBudgets()
+{
+    if (ctx == nullptr)
+    {
+        return;
+    }
+    fz_set_store_category_max(ctx, FZ_STORE_IMAGE, imagesMemory);
+    fz_set_store_category_max(ctx, FZ_STORE_FONT, fontsMemory);
+    fz_set_glyph_cache_max(ctx, (int) glyphsMemory);
+}
+
+uint32_t MuPdfBridge::pageListsSize()
+{
+    uint32_t size = 0;
+    for (uint32_t i = 0; pageLists != nullptr && i < pageCount; i++)
+    {
+        size += fz_display_list_size(ctx, pageLists[i]);
+    }
+    return size;
+}
+
+uint32_t MuPdfBridge::trimPageLists(uint32_t max, uint32_t keep)
+{
+    uint32_t size = pageListsSize();
+    if (size <= max)
+    {
+        return size;
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    for (uint32_t i = 0; i < pageCount; i++)
+    {
+        if (pageLists[i] != nullptr && i != keep)
+        {
+            uint32_t distance = i > currentPage ? i - currentPage : currentPage - i;
+            candidates.emplace_back(distance, i);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<uint32_t, uint32_t>>());
+    for (size_t i = 0; i < candidates.size() && size > max; i++)
+    {
+        uint32_t index = candidates[i].second;
+        size -= fz_display_list_size(ctx, pageLists[index]);
+        // Page itself stays, its list is rebuilt on next render
+        fz_drop_display_list(ctx, pageLists[index]);
+        pageLists[index] = nullptr;
+    }
+    return size;
+}
+
 void MuPdfBridge::processSetLayersMask(CmdRequest& request, CmdResponse& response)
 {
     response.cmd = CMD_RES_PDF_SET_LAYERS_MASK;
@@ -204,8 +352,16 @@ void MuPdfBridge::processSetLayersMask(CmdRequest& request, CmdResponse& respons
         return;
     }
 
-    uint32_t layersMask = 0;
-    if (!CmdDataIterator(request.first).getInt(&layersMask).isValid())
+    // One word per 32 layers
+    std::vector<uint32_t> layersMask;
+    CmdDataIterator iter(request.first);
+    while (iter.hasNext())
+    {
+        uint32_t word = 0;
+        iter.getInt(&word);
+        layersMask.push_back(word);
+    }
+    if (!iter.isValid())
     {
         LE("Bad request data");
         response.result = RES_BAD_REQ_DATA;
@@ -214,7 +370,35 @@ void MuPdfBridge::processSetLayersMask(CmdRequest& request, CmdResponse& respons
 
     this->layersmask = layersMask;
 
-    restart();
+    if (!applyLayersMask())
+    {
+        return;
+    }
+    // Document and store stay, only pages that checked optional content are rebuilt on demand
+    for (uint32_t i = 0; pageLists != nullptr && i < pageCount; i++)
+    {
+        if (!pageLayered[i])
+        {
+            continue;
+        }
+        if (pageLists[i] != nullptr)
+        {
+            fz_drop_display_list(ctx, pageLists[i]);
+            pageLists[i] = nullptr;
+        }
+        pageLayered[i] = false;
+        tileCache.removePage(i);
+        if (ctx->darkmode_objs && ctx->darkmode_objs[i].analyzed)
+        {
+            free(ctx->darkmode_objs[i].obj);
+            ctx->darkmode_objs[i].obj = nullptr;
+            ctx->darkmode_objs[i].analyzed = 0;
+        }
+    }
+    resetPrefetch();
+    // Extracted text depends on visible layers
+    saveTextIndex();
+    openTextIndex();
 }
 
 void MuPdfBridge::processOpen(CmdRequest& request, CmdResponse& response)
@@ -281,7 +465,7 @@ void MuPdfBridge::processOpen(CmdRequest& request, CmdResponse& response)
 
     if (ctx == nullptr) {
         LD("Creating context: storememory = %d", storememory);
-        ctx = fz_new_context(nullptr, nullptr, storememory);
+        ctx = fz_new_context(nullptr, MuPdfLocks(), storememory);
         if (!ctx)
         {
             LE("Out of Memory");
@@ -291,15 +475,16 @@ void MuPdfBridge::processOpen(CmdRequest& request, CmdResponse& response)
         ctx->erapdf_linearized_load = 0;
         ctx->erapdf_ignore_most_errors = 1;
         ctx->erapdf_has_password = (this->password && strlen(this->password));
+        applyMemoryBudgets();
     }
     if (document == nullptr) {
         LI("Opening document: %d %d", format, fd);
         LI(ctx->erapdf_has_password ? "Password present" : "No password");
         fz_try(ctx) {
             if (format == FORMAT_XPS) {
-                document = (fz_document*) xps_open_document_with_stream(ctx, fz_open_fd(ctx, dup(fd)));
+                document = (fz_document*) xps_open_document_with_stream(ctx, fz_open_fd_mmap(ctx, dup(fd)));
             } else {
-                document = (fz_document*) pdf_open_document_with_stream(ctx, fz_open_fd(ctx, dup(fd)));
+                document = (fz_document*) pdf_open_document_with_stream(ctx, fz_open_fd_mmap(ctx, dup(fd)));
             }
         } fz_catch(ctx) {
             const char* msg = fz_caught_message(ctx);
@@ -329,6 +514,7 @@ void MuPdfBridge::processOpen(CmdRequest& request, CmdResponse& response)
             LD("Document pages: %d", pageCount);
             pages = (fz_page**) calloc(pageCount, sizeof(fz_page*));
             pageLists = (fz_display_list**) calloc(pageCount, sizeof(fz_display_list*));
+            pageLayered = (bool*) calloc(pageCount, sizeof(bool));
         } fz_catch(ctx) {
             const char* msg = fz_caught_message(ctx);
             LE("Counting pages failed: %s", msg );
@@ -338,11 +524,12 @@ void MuPdfBridge::processOpen(CmdRequest& request, CmdResponse& response)
         }
     }
     response.addInt(pageCount);
-	pagesCache.reserve(5);
+    openTextIndex();
 	ctx->darkmode_objs = static_cast<darkmode_obj_page *>(malloc(sizeof(darkmode_obj_page) * pageCount));
     for (int i = 0; i < pageCount; i++)
     {
         ctx->darkmode_objs[i].analyzed = 0;
+        ctx->darkmode_objs[i].obj = nullptr;
     }
     ctx->erapdf_nightmode = config_invert_images;
     reflowManager = new ReflowManager(ctx, this);
@@ -393,7 +580,7 @@ void MuPdfBridge::processPageInfo(CmdRequest& request, CmdResponse& response)
     }
 }
 
-void MuPdfBridge::analyzePageForDarkMode(fz_context *ctx, int index, int w, int h)
+void MuPdfBridge::analyzePageForDarkMode(fz_context *ctx, int index)
 {
     if(ctx->darkmode_objs[index].analyzed != 0)
     {
@@ -408,29 +595,14 @@ void MuPdfBridge::analyzePageForDarkMode(fz_context *ctx, int index, int w, int
     }
     // Clear counter
     ctx->erapdf_setcolor_per_page = 0;
-    fz_rect area;
-    area.x0 = 0;
-    area.y0 = 0;
-    area.x1 = w;
-    area.y1 = h;
+    // Objects are classified straight from the display list, nothing is drawn
     fz_matrix ctm = fz_identity;
-    auto pixels = (uint8_t*) malloc(w * h * 4);
-    fz_device* device = nullptr;
-    fz_pixmap* pixmap = nullptr;
     fz_try(ctx) {
-                pixmap = fz_new_pixmap_with_data(ctx, fz_device_rgb(ctx), w, h, pixels);
-                fz_clear_pixmap_with_value(ctx, pixmap, 0xff);
-                device = fz_new_draw_device(ctx, pixmap);
-                fz_run_fake_display_list(ctx,pageLists[index], device, &ctm, &area, nullptr,index);
-            } fz_catch(ctx) {
+        fz_run_fake_display_list(ctx, pageLists[index], &ctm, nullptr, nullptr, index);
+    } fz_catch(ctx) {
         const char* msg = fz_caught_message(ctx);
         LE("%s", msg);
     }
-    if (pixels) {
-        free(pixels);
-    }
-    fz_drop_device(ctx, device);
-    fz_drop_pixmap(ctx, pixmap);
 }
 
 void MuPdfBridge::processPage(CmdRequest& request, CmdResponse& response)
@@ -465,10 +637,11 @@ void MuPdfBridge::processPage(CmdRequest& request, CmdResponse& response)
     }
 #endif
     ctx->previewmode = preview;
-    ctx->preview_heavy_image = 0; // Reset flag
+    currentPage = index;
     fz_page* page = getPage(index, true);
     ctx->previewmode = 0;
-    response.addInt(static_cast<uint32_t>(ctx->preview_heavy_image));
+    // Heavy image flag, JPX images are decoded reduced when drawn so nothing is skipped anymore
+    response.addInt(0);
     if (page == nullptr) {
         response.result = RES_INTERNAL_ERROR;
         return;
@@ -477,12 +650,7 @@ void MuPdfBridge::processPage(CmdRequest& request, CmdResponse& response)
     if(ctx->erapdf_nightmode)
     {
         //LW("OPEN AnalyzePageforDarkMode, index = %d",index);
-        fz_rect bounds = fz_empty_rect;
-        fz_bound_page(ctx, page, &bounds);
-
-        int w = fabs(bounds.x1 - bounds.x0);
-        int h = fabs(bounds.y1 - bounds.y0);
-        analyzePageForDarkMode(ctx,index,w,h);
+        analyzePageForDarkMode(ctx,index);
     }
 }
 
@@ -517,23 +685,64 @@ void MuPdfBridge::processPageFree(CmdRequest& request, CmdResponse& response)
     }
 #endif
     ctx->previewmode = 0;
-    if (pageLists[page_index]) {
+    freePage(page_index);
+}
+
+void MuPdfBridge::freePage(uint32_t index)
+{
+    if (pageLists[index]) {
         fz_try(ctx) {
-            fz_drop_display_list(ctx, pageLists[page_index]);
+            fz_drop_display_list(ctx, pageLists[index]);
         } fz_catch(ctx) {
             const char *msg = fz_caught_message(ctx);
             LE("%s", msg);
         }
-        pageLists[page_index] = nullptr;
+        pageLists[index] = nullptr;
     }
-    if (pages[page_index]) {
+    if (pages[index]) {
         fz_try(ctx) {
-            fz_drop_page(ctx, pages[page_index]);
+            fz_drop_page(ctx, pages[index]);
         } fz_catch(ctx) {
             const char *msg = fz_caught_message(ctx);
             LE("%s", msg);
         }
-        pages[page_index] = nullptr;
+        pages[index] = nullptr;
+    }
+}
+
+bool MuPdfBridge::prefetchPage(uint32_t index)
+{
+    if (document == nullptr || pages == nullptr || index >= pageCount) {
+        return false;
+    }
+    if (pageLists[index] != nullptr) {
+        return false;
+    }
+    // Page already held by the client keeps its display list until client frees the page
+    bool loaded = pages[index] == nullptr;
+    // List building is aborted as soon as client queues a request
+    fz_cookie cookie = { 0 };
+    setCancelSignal(&cookie.abort);
+    getPage(index, true, &cookie);
+    setCancelSignal(nullptr);
+    if (cookie.abort) {
+        if (loaded) {
+            freePage(index);
+        }
+        return false;
+    }
+    if (config_invert_images && pageLists[index] != nullptr) {
+        // Analysis is kept after the page is released, so the viewer gets it for free
+        ctx->erapdf_nightmode = config_invert_images;
+        analyzePageForDarkMode(ctx, index);
+    }
+    return loaded && pages != nullptr && pages[index] != nullptr;
+}
+
+void MuPdfBridge::releasePrefetchedPage(uint32_t index)
+{
+    if (pages != nullptr && index < pageCount) {
+        freePage(index);
     }
 }
 
@@ -685,7 +894,7 @@ void MuPdfBridge::processPageText(CmdRequest& request, CmdResponse& response)
     fz_bound_page(ctx, page, &bounds);
     int full_w = fabs(bounds.x1 - bounds.x0);
     int full_h = fabs(bounds.y1 - bounds.y0);
-    analyzePageForDarkMode(ctx,pageNo,full_w,full_h);
+    analyzePageForDarkMode(ctx,pageNo);
 
     for (int i = 0; i < ctx->darkmode_objs[pageNo].objcount; i++)
     {
@@ -707,7 +916,7 @@ void MuPdfBridge::processPageText(CmdRequest& request, CmdResponse& response)
     //processText((int) pageNo, response);
 }
 
-fz_page* MuPdfBridge::getPage(uint32_t index, bool decode)
+fz_page* MuPdfBridge::getPage(uint32_t index, bool decode, fz_cookie* cookie)
 {
 	if (index >= pageCount || index < 0) {
 		LE("Invalid page number: %d from %d", index, pageCount);
@@ -723,7 +932,7 @@ fz_page* MuPdfBridge::getPage(uint32_t index, bool decode)
             	LE("Try to reopen in non-linearized mode");
             	ctx->erapdf_linearized_load = 0;
             	restart();
-            	return getPage(index, decode);
+            	return getPage(index, decode, cookie);
             }
             return nullptr;
         }
@@ -734,7 +943,10 @@ fz_page* MuPdfBridge::getPage(uint32_t index, bool decode)
             pageLists[index] = fz_new_display_list(ctx);
             dev = fz_new_list_device(ctx, pageLists[index]);
             fz_matrix m = fz_identity;
-            fz_run_page(ctx, pages[index], dev, &m, nullptr);
+            pdf_ocg_descriptor* ocg = format == FORMAT_PDF ? ((pdf_document*) document)->ocg : nullptr;
+            int lookups = ocg ? ocg->lookups : 0;
+            fz_run_page(ctx, pages[index], dev, &m, cookie);
+            pageLayered[index] = ocg && ocg->lookups != lookups;
         }fz_always(ctx) {
             fz_drop_device(ctx, dev);
         } fz_catch(ctx) {
@@ -744,12 +956,20 @@ fz_page* MuPdfBridge::getPage(uint32_t index, bool decode)
             	LE("Try to reopen in non-linearized mode");
             	ctx->erapdf_linearized_load = 0;
             	restart();
-            	return getPage(index, decode);
+            	return getPage(index, decode, cookie);
             } else {
             	fz_drop_display_list(ctx, pageLists[index]);
             	pageLists[index] = nullptr;
             }
         }
+        if (cookie != nullptr && cookie->abort && pageLists[index] != nullptr) {
+            // Unfinished list would draw part of the page
+            fz_drop_display_list(ctx, pageLists[index]);
+            pageLists[index] = nullptr;
+        }
+        if (listsMemory != 0 && pageLists[index] != nullptr) {
+            trimPageLists(listsMemory, index);
+        }
     }
     return pages[index];
 }
@@ -758,20 +978,22 @@ bool MuPdfBridge::restart()
 {
     release();
     LD("Creating context: storememory = %d", storememory);
-    ctx = fz_new_context(nullptr, nullptr, storememory);
+    ctx = fz_new_context(nullptr, MuPdfLocks(), storememory);
     if (!ctx) {
         return false;
     }
+    applyMemoryBudgets();
     ctx->erapdf_ignore_most_errors = 1;
     fz_try(ctx) {
         if (format == FORMAT_XPS) {
-            document = (fz_document*) xps_open_document_with_stream(ctx, fz_open_fd(ctx, dup(fd)));
+            document = (fz_document*) xps_open_document_with_stream(ctx, fz_open_fd_mmap(ctx, dup(fd)));
         } else {
-            document = (fz_document*) pdf_open_document_with_stream(ctx, fz_open_fd(ctx, dup(fd)));
+            document = (fz_document*) pdf_open_document_with_stream(ctx, fz_open_fd_mmap(ctx, dup(fd)));
         }
         LD("Document pages: %d", pageCount);
         pages = (fz_page**) calloc(pageCount, sizeof(fz_page*));
         pageLists = (fz_display_list**) calloc(pageCount, sizeof(fz_display_list*));
+        pageLayered = (bool*) calloc(pageCount, sizeof(bool));
     } fz_catch(ctx) {
         const char* msg = fz_caught_message(ctx);
         LE("%s", msg);
@@ -796,6 +1018,8 @@ bool MuPdfBridge::restart()
 
 void MuPdfBridge::release()
 {
+    tileCache.clear();
+    resetPrefetch();
     if (pageLists != nullptr) {
         for (int i = 0; i < pageCount; i++) {
             if (pageLists[i] != nullptr) {
@@ -805,6 +1029,10 @@ void MuPdfBridge::release()
         free(pageLists);
         pageLists = nullptr;
     }
+    if (pageLayered != nullptr) {
+        free(pageLayered);
+        pageLayered = nullptr;
+    }
     if (pages != nullptr) {
         for (int i = 0; i < pageCount; i++) {
             if (pages[i] != nullptr) {
@@ -825,17 +1053,24 @@ void MuPdfBridge::release()
     }
 }
 
-void MuPdfBridge::applyLayersMask()
+bool MuPdfBridge::applyLayersMask()
 {
+    bool changed = false;
     if (document && format == FORMAT_PDF) {
         pdf_ocg_descriptor* ocg;
         ocg = ((pdf_document*) document)->ocg;
         if (ocg) {
-            for (int i = 0; i < std::min(31, ocg->len); i++) {
-                ocg->ocgs[i].state = ((layersmask & (1 << i)) != 0) ? 1 : 0;
+            for (int i = 0; i < ocg->len; i++) {
+                size_t word = (size_t) i / 32;
+                int state = (word >= layersmask.size() || (layersmask[word] & (1u << (i % 32))) != 0) ? 1 : 0;
+                if (ocg->ocgs[i].state != state) {
+                    ocg->ocgs[i].state = state;
+                    changed = true;
+                }
             }
         }
     }
+    return changed;
 }
 
 void MuPdfBridge::processGetLayersList(CmdRequest& request, CmdResponse& response)
@@ -1030,17 +1265,13 @@ bool MuPdfBridge::renderPage(uint32_t index, int w, int h, unsigned char* pixels
     if(ctx->erapdf_nightmode)
     {
         //LW("RENDER AnalyzePageforDarkMode, index = %d",index);
-
-        //we need to get fresh page bounds because this method can be called from pagecrop
-        fz_rect bounds = fz_empty_rect;
-        fz_bound_page(ctx, page, &bounds);
-
-        int full_w = fabs(bounds.x1 - bounds.x0);
-        int full_h = fabs(bounds.y1 - bounds.y0);
-        analyzePageForDarkMode(ctx,index,full_w,full_h);
+        analyzePageForDarkMode(ctx,index);
     }
     // Clear counter
     ctx->erapdf_setcolor_per_page = 0;
+    if (renderThreads > 1 && h >= 2 * RENDER_BAND_MIN_HEIGHT) {
+        return renderPageBanded(index, w, h, pixels, ctm);
+    }
     bool res = false;
     fz_rect area;
     area.x0 = 0;
@@ -1049,17 +1280,20 @@ bool MuPdfBridge::renderPage(uint32_t index, int w, int h, unsigned char* pixels
     area.y1 = h;
     fz_device* device = nullptr;
     fz_pixmap* pixmap = nullptr;
+    fz_cookie cookie = { 0 };
+    setCancelSignal(&cookie.abort);
     fz_try(ctx) {
         pixmap = fz_new_pixmap_with_data(ctx, fz_device_rgb(ctx), w, h, pixels);
         fz_clear_pixmap_with_value(ctx, pixmap, 0xff);
         device = fz_new_draw_device(ctx, pixmap);
-        fz_run_display_list(ctx, pageLists[index], device, ctm, &area, nullptr,index);
-        res = true;
+        fz_run_display_list(ctx, pageLists[index], device, ctm, &area, &cookie, index);
+        res = !cookie.abort;
     } fz_catch(ctx) {
         const char* msg = fz_caught_message(ctx);
         LE("%s", msg);
         res = false;
     }
+    setCancelSignal(nullptr);
     fz_drop_device(ctx, device);
     fz_drop_pixmap(ctx, pixmap);
     return res;
@@ -1194,11 +1428,76 @@ void MuPdfBridge::processPageRender(CmdRequest& request, CmdResponse& response)
     //LW("RENDER page %d , preview = %d",page_index,preview);
     ctx->erapdf_nightmode = config_invert_images;
     auto pixelsHolder = new CmdData();
-    auto pixels = pixelsHolder->newByteArray((w) * (h) * 4);
+    auto pixels = newRenderPixels(pixelsHolder, (w) * (h) * 4);
+    currentPage = page_index;
     if (renderPage(page_index, w, h, pixels, &ctm)) {
         response.addData(pixelsHolder);
+        schedulePrefetch(page_index, pageCount);
     } else {
         response.result = RES_INTERNAL_ERROR;
         delete pixelsHolder;
     }
-}
\ No newline at end of file
+}
+
+void MuPdfBridge::processPageTile(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_PAGE_TILE;
+    if (document == nullptr || pages == nullptr) {
+        LE("Document not yet opened");
+        response.result = RES_ILLEGAL_STATE;
+        return;
+    }
+    StTileKey key;
+    CmdDataIterator iter(request.first);
+    iter.getInt(&key.page).getFloat(&key.zoom).getInt(&key.x).getInt(&key.y).getInt(&key.size);
+    if (!iter.isValid() || key.size == 0 || key.size > TILE_MAX_SIZE || key.zoom <= 0) {
+        LE("Bad request data");
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    if (key.page >= pageCount) {
+        LE("Bad page index: %d", key.page);
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    key.config = tileConfig;
+    schedulePrefetch(key.page, pageCount);
+    uint32_t size = key.size * key.size * 4;
+    auto pixelsHolder = new CmdData();
+    auto pixels = newRenderPixels(pixelsHolder, size);
+    const uint8_t* cached = tileCache.get(key);
+    if (cached != nullptr) {
+        memcpy(pixels, cached, size);
+        response.addData(pixelsHolder);
+        return;
+    }
+    fz_page* page = getPage(key.page, false);
+    if (!page) {
+        LE("No page %d found", key.page);
+        response.result = RES_INTERNAL_ERROR;
+        delete pixelsHolder;
+        return;
+    }
+    currentPage = key.page;
+    fz_rect bounds = fz_empty_rect;
+    fz_bound_page(ctx, page, &bounds);
+    // Page origin is moved to the top left corner of the tile
+    fz_matrix ctm = fz_identity;
+    ctm.a = key.zoom;
+    ctm.d = key.zoom;
+    ctm.e = -bounds.x0 * key.zoom - (float) key.x * key.size;
+    ctm.f = -bounds.y0 * key.zoom - (float) key.y * key.size;
+    ctx->erapdf_slowcmyk = HARDCONFIG_MUPDF_SLOW_CMYK;
+    ctx->flag_interpolate_images = 1;
+    ctx->erapdf_nightmode = config_invert_images;
+    if (!renderPage(key.page, key.size, key.size, pixels, &ctm)) {
+        response.result = RES_INTERNAL_ERROR;
+        delete pixelsHolder;
+        return;
+    }
+    uint8_t* tile = tileCache.put(key, size);
+    if (tile != nullptr) {
+        memcpy(tile, pixels, size);
+    }
+    response.addData(pixelsHolder);
+}
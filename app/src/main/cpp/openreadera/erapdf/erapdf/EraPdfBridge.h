@@ -34,8 +34,11 @@ extern "C" {
 #include "StBridge.h"
 #include "StSearchUtils.h"
 #include "openreadera.h"
+#include "MuPdfTextIndex.h"
 
 #define CURRENT_MAX_VERSION 2
+// Page bands lower than this are not worth a separate render thread
+#define RENDER_BAND_MIN_HEIGHT 128
 class ReflowManager;
 
 class SearchResult{
@@ -156,54 +159,14 @@ public:
     }
 };
 
-class PageHitboxesCash
-{
-private:
-    int page_ = -1;
-    std::vector<Hitbox> PageHitboxes_;
-public:
-    PageHitboxesCash(){};
-    PageHitboxesCash(int page, std::vector<Hitbox> Hitboxes){
-        page_ = page;
-        PageHitboxes_ = Hitboxes;
-    }
-
-    int getPage()
-    {
-        return page_;
-    }
-
-    std::vector<Hitbox> getArray()
-    {
-        return PageHitboxes_;
-    };
-
-    Hitbox get(int num)
-    {
-        return PageHitboxes_.at(num);
-    }
-
-    int length() {
-        return PageHitboxes_.size();
-    }
-
-    bool isEmpty()
-    {
-        return ((page_ == -1) || (PageHitboxes_.empty()));
-    }
-
-    void reset()
-    {
-        page_ = -1;
-        PageHitboxes_.clear();
-    }
-};
 class ReflowManager;
 class MuPdfBridge : public StBridge
 {
 private:
     int config_format = 0;
     int config_invert_images = 0;
+    int renderThreads = 1;
+    uint32_t tileConfig = 0;
 	int fd;
     char* password;
 
@@ -214,14 +177,25 @@ private:
     uint32_t pageCount;
     fz_page **pages;
     fz_display_list **pageLists;
+    /// Display lists built with optional content checks, rebuilt when layers change
+    bool *pageLayered;
 
     int storememory;
+    /// Budgets in bytes of display lists, decoded images, glyphs and fonts, 0 - no budget of its own
+    uint32_t listsMemory = 0;
+    uint32_t imagesMemory = 0;
+    uint32_t glyphsMemory = 0;
+    uint32_t fontsMemory = 0;
+    /// Last viewed page, display lists of pages far from it are dropped first
+    uint32_t currentPage = 0;
     int format;
-    int layersmask;
+    /// Visibility of layer i is bit i % 32 of word i / 32, layers past the mask are visible
+    std::vector<uint32_t> layersmask;
 
     int searchPackCounter = 0;
     std::set<std::string> fonts;
-    std::vector<PageHitboxesCash> pagesCache;
+    MuPdfTextIndex textIndex;
+    std::string textIndexDir;
     ReflowManager* reflowManager;
 public:
     MuPdfBridge();
@@ -237,12 +211,15 @@ protected:
     void processPage(CmdRequest& request, CmdResponse& response);
 	void processPageLinks(CmdRequest& request, CmdResponse& response);
     void processPageRender(CmdRequest& request, CmdResponse& response);
+    void processPageTile(CmdRequest& request, CmdResponse& response);
     void processPageFree(CmdRequest& request, CmdResponse& response);
     void processOutline(CmdRequest& request, CmdResponse& response);
     void processPageText(CmdRequest& request, CmdResponse& response);
     void processFontsConfig(CmdRequest& request, CmdResponse& response);
     void processConfig(CmdRequest& request, CmdResponse& response);
     void processStorage(CmdRequest& request, CmdResponse& response);
+    void processMemory(CmdRequest& request, CmdResponse& response);
+    void processTrimMemory(CmdRequest& request, CmdResponse& response);
     void processSystemFont(CmdRequest& request, CmdResponse& response);
     void processGetMissedFonts(CmdRequest& request, CmdResponse& response);
     void processGetLayersList(CmdRequest& request, CmdResponse& response);
@@ -257,8 +234,9 @@ protected:
     friend class ReflowManager;
 
 
-    fz_page* getPage(uint32_t index, bool decode);
+    fz_page* getPage(uint32_t index, bool decode, fz_cookie* cookie = nullptr);
     bool renderPage(uint32_t index, int w, int h, unsigned char* pixels, const fz_matrix_s* ctm);
+    bool renderPageBanded(uint32_t index, int w, int h, unsigned char* pixels, const fz_matrix_s* ctm);
     bool restart();
     void release();
     void resetFonts();
@@ -268,7 +246,19 @@ protected:
     void processTextSearchHitboxes(CmdRequest &request, CmdResponse &response);
     void processSearchCounter(CmdRequest &request, CmdResponse &response);
     void processPageRangeText(CmdRequest &request, CmdResponse &response);
-    void applyLayersMask();
+    void processTextIndex(CmdRequest &request, CmdResponse &response);
+    bool applyLayersMask();
+    void openTextIndex();
+    void saveTextIndex();
+    bool indexNextPage();
+    bool processIdle() override;
+    bool prefetchPage(uint32_t index) override;
+    void releasePrefetchedPage(uint32_t index) override;
+    void freePage(uint32_t index);
+    void applyMemoryBudgets();
+    uint32_t pageListsSize();
+    /// Drops display lists farthest from current page until they fit into max bytes, list of keep page stays
+    uint32_t trimPageLists(uint32_t max, uint32_t keep);
 
     std::string GetXpathFromPageById(std::vector<Hitbox> hitboxes, int id, bool addcoords, bool reverse);
     std::string GetXpathFromPageById(int page, int id, bool addcoords, bool reverse);
@@ -288,7 +278,7 @@ protected:
     std::vector<Hitbox> GetSearchHitboxesPrevPage(std::vector<Hitbox> base, std::wstring query, int last_len);
     std::vector<Hitbox> GetSearchHitboxesNextPage(std::vector<Hitbox> base, int page, std::wstring query);
     */
-    void analyzePageForDarkMode(fz_context *ctx, int index, int w, int h);
+    void analyzePageForDarkMode(fz_context *ctx, int index);
 
     std::string GetXpathFromPageByCoords(int page, float x, float y, bool addcoords, bool reverse);
 
@@ -296,5 +286,6 @@ protected:
 };
 
 bool isQuote(int ch);
+fz_locks_context* MuPdfLocks();
 
 #endif
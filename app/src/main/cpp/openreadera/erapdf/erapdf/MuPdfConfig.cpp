@@ -16,6 +16,7 @@
  */
 #include <cstdlib>
 #include <set>
+#include <algorithm>
 #include "ore_log.h"
 #include "StProtocol.h"
 #include "EraPdfBridge.h"
@@ -24,6 +25,8 @@ void MuPdfBridge::processConfig(CmdRequest& request, CmdResponse& response)
 {
     LD("processConfig");
     response.cmd = CMD_RES_SET_CONFIG;
+    // Cached tiles rendered with previous settings are not valid anymore
+    tileConfig++;
     CmdDataIterator iter(request.first);
     while (iter.hasNext()) {
         uint32_t key;
@@ -36,6 +39,13 @@ void MuPdfBridge::processConfig(CmdRequest& request, CmdResponse& response)
         const char* val = reinterpret_cast<const char*>(temp_val);
         if (key == CONFIG_MUPDF_INVERT_IMAGES) {
             config_invert_images = atoi(val);
+        } else if (key == CONFIG_MUPDF_RENDER_THREADS) {
+            renderThreads = std::max(1, atoi(val));
+        } else if (key == CONFIG_MUPDF_TEXT_INDEX_DIR) {
+            textIndexDir = val;
+            if (document != nullptr && textIndex.getIndexedCount() == 0) {
+                openTextIndex();
+            }
         } else {
             LE("processConfig unknown key: key=%d, val=%s", key, val);
         }
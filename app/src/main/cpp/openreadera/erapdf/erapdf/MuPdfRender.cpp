@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#include <pthread.h>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "ore_log.h"
+#include "EraPdfBridge.h"
+
+static pthread_mutex_t mupdf_mutexes[FZ_LOCK_MAX];
+
+static void mupdf_lock(void* user, int lock)
+{
+    pthread_mutex_lock(&mupdf_mutexes[lock]);
+}
+
+static void mupdf_unlock(void* user, int lock)
+{
+    pthread_mutex_unlock(&mupdf_mutexes[lock]);
+}
+
+fz_locks_context* MuPdfLocks()
+{
+    static fz_locks_context locks = { nullptr, nullptr, nullptr };
+    if (locks.lock == nullptr) {
+        for (int i = 0; i < FZ_LOCK_MAX; i++) {
+            pthread_mutex_init(&mupdf_mutexes[i], nullptr);
+        }
+        locks.lock = mupdf_lock;
+        locks.unlock = mupdf_unlock;
+    }
+    return &locks;
+}
+
+/// Cloned context shares store and caches, but EraPDF flags have to be copied
+static void copyEraPdfFlags(fz_context* dst, fz_context* src)
+{
+    dst->erapdf_nightmode = src->erapdf_nightmode;
+    dst->erapdf_slowcmyk = src->erapdf_slowcmyk;
+    dst->erapdf_ignore_most_errors = src->erapdf_ignore_most_errors;
+    dst->erapdf_linearized_load = src->erapdf_linearized_load;
+    dst->erapdf_file_stream_offset = src->erapdf_file_stream_offset;
+    dst->erapdf_has_password = src->erapdf_has_password;
+    dst->previewmode = src->previewmode;
+    dst->flag_interpolate_images = src->flag_interpolate_images;
+    dst->darkmode_objs = src->darkmode_objs;
+    dst->ignore_rects_num = src->ignore_rects_num;
+    memcpy(dst->ignore_rects, src->ignore_rects, sizeof(dst->ignore_rects));
+}
+
+class RenderBand
+{
+public:
+    fz_context* ctx = nullptr;
+    fz_display_list* list = nullptr;
+    const fz_matrix* ctm = nullptr;
+    /// MuPDF updates cookie progress while rendering, so every thread needs its own
+    fz_cookie cookie = { 0 };
+    unsigned char* pixels = nullptr;
+    int index = 0;
+    int w = 0;
+    int y = 0;
+    int h = 0;
+    bool threaded = false;
+    bool result = false;
+};
+
+static bool renderBand(RenderBand* band)
+{
+    fz_context* ctx = band->ctx;
+    fz_rect area;
+    area.x0 = 0;
+    area.y0 = band->y;
+    area.x1 = band->w;
+    area.y1 = band->y + band->h;
+    fz_device* device = nullptr;
+    fz_pixmap* pixmap = nullptr;
+    bool res = false;
+    fz_try(ctx) {
+        pixmap = fz_new_pixmap_with_data(ctx, fz_device_rgb(ctx), band->w, band->h, band->pixels);
+        pixmap->y = band->y;
+        fz_clear_pixmap_with_value(ctx, pixmap, 0xff);
+        device = fz_new_draw_device(ctx, pixmap);
+        fz_run_display_list(ctx, band->list, device, band->ctm, &area, &band->cookie, band->index);
+        res = !band->cookie.abort;
+    } fz_catch(ctx) {
+        LE("Band %d: %s", band->y, fz_caught_message(ctx));
+        res = false;
+    }
+    fz_drop_device(ctx, device);
+    fz_drop_pixmap(ctx, pixmap);
+    return res;
+}
+
+static void* renderBandThread(void* arg)
+{
+    auto band = static_cast<RenderBand*>(arg);
+    band->result = renderBand(band);
+    return nullptr;
+}
+
+bool MuPdfBridge::renderPageBanded(uint32_t index, int w, int h, unsigned char* pixels,
+        const fz_matrix_s* ctm)
+{
+    int count = std::min(renderThreads, h / RENDER_BAND_MIN_HEIGHT);
+    int bandHeight = (h + count - 1) / count;
+    std::vector<RenderBand> bands((size_t) count);
+    std::vector<pthread_t> threads((size_t) count);
+
+    setCancelSignal(nullptr);
+    for (int i = 0; i < count; i++) {
+        addCancelSignal(&bands[i].cookie.abort);
+    }
+    for (int i = 0; i < count; i++) {
+        RenderBand& band = bands[i];
+        band.list = pageLists[index];
+        band.ctm = ctm;
+        band.index = index;
+        band.w = w;
+        band.y = i * bandHeight;
+        band.h = std::min(bandHeight, h - band.y);
+        band.pixels = pixels + band.y * w * 4;
+        band.ctx = ctx;
+        if (i == 0) {
+            // First band is rendered by calling thread
+            continue;
+        }
+        fz_context* clone = fz_clone_context(ctx);
+        if (clone == nullptr) {
+            continue;
+        }
+        copyEraPdfFlags(clone, ctx);
+        band.ctx = clone;
+        band.threaded = pthread_create(&threads[i], nullptr, renderBandThread, &band) == 0;
+        if (!band.threaded) {
+            fz_drop_context(clone);
+            band.ctx = ctx;
+        }
+    }
+    bool res = true;
+    for (int i = 0; i < count; i++) {
+        RenderBand& band = bands[i];
+        if (!band.threaded) {
+            band.result = renderBand(&band);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        RenderBand& band = bands[i];
+        if (band.threaded) {
+            pthread_join(threads[i], nullptr);
+            fz_drop_context(band.ctx);
+        }
+        res = res && band.result;
+    }
+    setCancelSignal(nullptr);
+    LD("Page %d rendered by %d bands", index, count);
+    return res;
+}
@@ -807,29 +807,100 @@ void postProcessBlock(std::vector<Hitbox> result, fz_context *ctx, fz_text_page
 
 std::vector<Hitbox> MuPdfBridge::processTextToArray(int pageNo, int version)
 {
-    if (!pagesCache.empty() && ( version == -1 || version == CURRENT_MAX_VERSION) )
+    bool indexable = version == -1 || version == CURRENT_MAX_VERSION;
+    if (indexable && textIndex.has(pageNo))
     {
-        for (int i = pagesCache.size()-1; i >= 0; i--)
-        {
-            if (pagesCache.at(i).getPage() == pageNo)
-            {
-                return pagesCache.at(i).getArray();
-            }
-        }
-        if (pagesCache.size() >= 5)
-        {
-            pagesCache.erase(pagesCache.begin());
-        }
+        return textIndex.get(pageNo);
     }
-
     std::vector<Hitbox> boxes = processTextToArray_imp(pageNo, version);
-    if(version == -1 || version == CURRENT_MAX_VERSION )
+    if (indexable)
     {
-        pagesCache.push_back(PageHitboxesCash(pageNo, boxes));
+        textIndex.put(pageNo, boxes);
     }
     return boxes;
 }
 
+void MuPdfBridge::openTextIndex()
+{
+    uint64_t key = MuPdfTextIndex::fileKey(fd) ^ MuPdfTextIndex::layersKey(layersmask);
+    textIndex.reset(pageCount, key);
+    if (!textIndexDir.empty())
+    {
+        char name[32];
+        sprintf(name, "/%016llx.pdftext", (unsigned long long) key);
+        textIndex.load(textIndexDir + name);
+    }
+}
+
+void MuPdfBridge::saveTextIndex()
+{
+    if (!textIndexDir.empty() && textIndex.isDirty())
+    {
+        char name[32];
+        sprintf(name, "/%016llx.pdftext", (unsigned long long) textIndex.getKey());
+        textIndex.save(textIndexDir + name);
+    }
+}
+
+bool MuPdfBridge::indexNextPage()
+{
+    int page = textIndex.nextMissing();
+    if (page < 0 || document == nullptr || pages == nullptr)
+    {
+        return false;
+    }
+    // Pages loaded only for indexing are released right away
+    bool loaded = pages[page] != nullptr;
+    textIndex.put(page, processTextToArray_imp(page));
+    if (!loaded && pages[page] != nullptr && (pageLists == nullptr || pageLists[page] == nullptr))
+    {
+        fz_drop_page(ctx, pages[page]);
+        pages[page] = nullptr;
+    }
+    return true;
+}
+
+bool MuPdfBridge::processIdle()
+{
+    if (indexNextPage() && textIndex.nextMissing() >= 0)
+    {
+        return true;
+    }
+    saveTextIndex();
+    return false;
+}
+
+void MuPdfBridge::processTextIndex(CmdRequest &request, CmdResponse &response)
+{
+    response.cmd = CMD_RES_TEXT_INDEX;
+    if (document == nullptr || pages == nullptr)
+    {
+        LE("Document not yet opened");
+        response.result = RES_ILLEGAL_STATE;
+        return;
+    }
+    uint32_t mode = 0;
+    if (!CmdDataIterator(request.first).getInt(&mode).isValid())
+    {
+        LE("Bad request data");
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    if (mode == TEXT_INDEX_BUILD_BACKGROUND)
+    {
+        requestIdle();
+    }
+    else if (mode == TEXT_INDEX_BUILD_NOW)
+    {
+        while (!isCancelled() && indexNextPage())
+        {
+        }
+        saveTextIndex();
+    }
+    response.addInt(textIndex.getIndexedCount());
+    response.addInt(textIndex.getPageCount());
+}
+
 std::vector<Hitbox> MuPdfBridge::processTextToArray_imp(int pageNo, int version)
 {
     pagenum = pageNo;
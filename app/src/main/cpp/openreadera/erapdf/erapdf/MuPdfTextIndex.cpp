@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "ore_log.h"
+#include "MuPdfTextIndex.h"
+
+constexpr static bool LOG = false;
+
+#define TEXT_INDEX_MAGIC        0x58444954
+#define TEXT_INDEX_VERSION      1
+#define TEXT_INDEX_HASH_CHUNK   (64 * 1024)
+
+#define XPOINTER_EMPTY  -1
+#define XPOINTER_CUSTOM -2
+
+void MuPdfPageText::assign(uint32_t page, const std::vector<Hitbox>& hitboxes)
+{
+    clear();
+    indexed = true;
+    ends.reserve(hitboxes.size());
+    boxes.reserve(hitboxes.size() * 4);
+    ids.reserve(hitboxes.size() * 3);
+    char xpath[100];
+    for (uint32_t i = 0; i < hitboxes.size(); i++) {
+        const Hitbox& hitbox = hitboxes[i];
+        text.append(hitbox.text_);
+        ends.push_back((uint32_t) text.size());
+        boxes.push_back(hitbox.left_);
+        boxes.push_back(hitbox.right_);
+        boxes.push_back(hitbox.top_);
+        boxes.push_back(hitbox.bottom_);
+        int p = -1, b = -1, l = -1, c = -1;
+        if (hitbox.xpointer_.empty()) {
+            b = XPOINTER_EMPTY;
+        } else if (sscanf(hitbox.xpointer_.c_str(), "/page[%d]/block[%d]/line[%d]/char[%d]",
+                &p, &b, &l, &c) != 4 || p != (int) page || b < 0) {
+            b = XPOINTER_CUSTOM;
+        } else {
+            sprintf(xpath, "/page[%d]/block[%d]/line[%d]/char[%d]", p, b, l, c);
+            if (hitbox.xpointer_ != xpath) {
+                b = XPOINTER_CUSTOM;
+            }
+        }
+        if (b == XPOINTER_CUSTOM) {
+            xpointers[i] = hitbox.xpointer_;
+        }
+        ids.push_back(b);
+        ids.push_back(l);
+        ids.push_back(c);
+    }
+}
+
+std::vector<Hitbox> MuPdfPageText::toHitboxes(uint32_t page) const
+{
+    std::vector<Hitbox> result;
+    result.reserve(ends.size());
+    char xpath[100];
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < ends.size(); i++) {
+        std::string xpointer;
+        int32_t b = ids[i * 3];
+        if (b >= 0) {
+            sprintf(xpath, "/page[%d]/block[%d]/line[%d]/char[%d]",
+                    page, b, ids[i * 3 + 1], ids[i * 3 + 2]);
+            xpointer = xpath;
+        } else if (b == XPOINTER_CUSTOM) {
+            xpointer = xpointers.at(i);
+        }
+        result.emplace_back(boxes[i * 4], boxes[i * 4 + 1], boxes[i * 4 + 2], boxes[i * 4 + 3],
+                text.substr(start, ends[i] - start), xpointer);
+        start = ends[i];
+    }
+    return result;
+}
+
+void MuPdfPageText::clear()
+{
+    indexed = false;
+    text.clear();
+    ends.clear();
+    boxes.clear();
+    ids.clear();
+    xpointers.clear();
+}
+
+void MuPdfTextIndex::reset(uint32_t pageCount, uint64_t key)
+{
+    pages.clear();
+    pages.resize(pageCount);
+    indexedCount = 0;
+    this->key = key;
+    dirty = false;
+}
+
+bool MuPdfTextIndex::has(uint32_t page) const
+{
+    return page < pages.size() && pages[page].indexed;
+}
+
+std::vector<Hitbox> MuPdfTextIndex::get(uint32_t page) const
+{
+    return pages.at(page).toHitboxes(page);
+}
+
+void MuPdfTextIndex::put(uint32_t page, const std::vector<Hitbox>& hitboxes)
+{
+    if (page >= pages.size()) {
+        return;
+    }
+    if (!pages[page].indexed) {
+        indexedCount++;
+    }
+    pages[page].assign(page, hitboxes);
+    dirty = true;
+}
+
+int MuPdfTextIndex::nextMissing() const
+{
+    if (indexedCount == pages.size()) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < pages.size(); i++) {
+        if (!pages[i].indexed) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <typename T>
+static bool writeArray(FILE* file, const T* data, uint32_t count)
+{
+    return fwrite(&count, sizeof(count), 1, file) == 1
+            && (count == 0 || fwrite(data, sizeof(T), count, file) == count);
+}
+
+/// Corrupted counts must not make us allocate more than the file holds
+static bool fitsFile(FILE* file, uint64_t bytes)
+{
+    struct stat st;
+    long pos = ftell(file);
+    return pos >= 0 && fstat(fileno(file), &st) == 0 && pos <= st.st_size
+            && bytes <= (uint64_t) (st.st_size - pos);
+}
+
+template <typename T>
+static bool readArray(FILE* file, std::vector<T>& data)
+{
+    uint32_t count = 0;
+    if (fread(&count, sizeof(count), 1, file) != 1 || !fitsFile(file, (uint64_t) count * sizeof(T))) {
+        return false;
+    }
+    data.resize(count);
+    return count == 0 || fread(data.data(), sizeof(T), count, file) == count;
+}
+
+bool MuPdfTextIndex::save(const std::string& path)
+{
+    std::string temp = path + ".tmp";
+    FILE* file = fopen(temp.c_str(), "wb");
+    if (file == nullptr) {
+        LE("MuPdfTextIndex: Cannot create %s", temp.c_str());
+        return false;
+    }
+    uint32_t header[4] = { TEXT_INDEX_MAGIC, TEXT_INDEX_VERSION, (uint32_t) pages.size(), indexedCount };
+    bool res = fwrite(header, sizeof(header), 1, file) == 1 && fwrite(&key, sizeof(key), 1, file) == 1;
+    std::vector<uint32_t> chars;
+    for (uint32_t i = 0; res && i < pages.size(); i++) {
+        const MuPdfPageText& page = pages[i];
+        if (!page.indexed) {
+            continue;
+        }
+        // wchar_t size is platform dependent, so characters are stored as 4 bytes
+        chars.assign(page.text.begin(), page.text.end());
+        res = fwrite(&i, sizeof(i), 1, file) == 1
+                && writeArray(file, chars.data(), chars.size())
+                && writeArray(file, page.ends.data(), page.ends.size())
+                && writeArray(file, page.boxes.data(), page.boxes.size())
+                && writeArray(file, page.ids.data(), page.ids.size());
+        uint32_t custom = page.xpointers.size();
+        res = res && fwrite(&custom, sizeof(custom), 1, file) == 1;
+        for (auto it = page.xpointers.begin(); res && it != page.xpointers.end(); ++it) {
+            res = fwrite(&it->first, sizeof(it->first), 1, file) == 1
+                    && writeArray(file, it->second.data(), it->second.size());
+        }
+    }
+    res = fclose(file) == 0 && res;
+    if (!res || rename(temp.c_str(), path.c_str()) != 0) {
+        LE("MuPdfTextIndex: Cannot save %s", path.c_str());
+        unlink(temp.c_str());
+        return false;
+    }
+    dirty = false;
+    LD("MuPdfTextIndex: Saved %u/%zu pages to %s", indexedCount, pages.size(), path.c_str());
+    return true;
+}
+
+/// Checks what toHitboxes() relies on
+static bool isValidPage(const MuPdfPageText& page, size_t textSize)
+{
+    if (page.boxes.size() != page.ends.size() * 4 || page.ids.size() != page.ends.size() * 3) {
+        return false;
+    }
+    uint32_t start = 0;
+    for (uint32_t i = 0; i < page.ends.size(); i++) {
+        if (page.ends[i] < start) {
+            return false;
+        }
+        start = page.ends[i];
+        if (page.ids[i * 3] == XPOINTER_CUSTOM && page.xpointers.count(i) == 0) {
+            return false;
+        }
+    }
+    return start == textSize;
+}
+
+bool MuPdfTextIndex::load(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        LDD(LOG, "MuPdfTextIndex: No index file %s", path.c_str());
+        return false;
+    }
+    uint32_t header[4];
+    uint64_t fileKey = 0;
+    bool res = fread(header, sizeof(header), 1, file) == 1 && fread(&fileKey, sizeof(fileKey), 1, file) == 1
+            && header[0] == TEXT_INDEX_MAGIC && header[1] == TEXT_INDEX_VERSION
+            && header[2] == pages.size() && header[3] <= pages.size() && fileKey == key;
+    std::vector<MuPdfPageText> loaded(pages.size());
+    std::vector<uint32_t> chars;
+    for (uint32_t n = 0; res && n < header[3]; n++) {
+        uint32_t index = 0;
+        // Every page is written once, duplicates would make indexed count wrong
+        res = fread(&index, sizeof(index), 1, file) == 1 && index < loaded.size() && !loaded[index].indexed;
+        if (!res) {
+            break;
+        }
+        MuPdfPageText& page = loaded[index];
+        res = readArray(file, chars) && readArray(file, page.ends)
+                && readArray(file, page.boxes) && readArray(file, page.ids);
+        uint32_t custom = 0;
+        res = res && fread(&custom, sizeof(custom), 1, file) == 1;
+        for (uint32_t i = 0; res && i < custom; i++) {
+            uint32_t id = 0;
+            std::vector<char> xpointer;
+            res = fread(&id, sizeof(id), 1, file) == 1 && readArray(file, xpointer);
+            page.xpointers[id] = std::string(xpointer.begin(), xpointer.end());
+        }
+        res = res && isValidPage(page, chars.size());
+        page.text.assign(chars.begin(), chars.end());
+        page.indexed = res;
+    }
+    fclose(file);
+    if (!res) {
+        LE("MuPdfTextIndex: Bad index file %s", path.c_str());
+        return false;
+    }
+    pages.swap(loaded);
+    indexedCount = header[3];
+    dirty = false;
+    LD("MuPdfTextIndex: Loaded %u/%zu pages from %s", indexedCount, pages.size(), path.c_str());
+    return true;
+}
+
+static uint64_t fnv1a(uint64_t hash, const uint8_t* data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t MuPdfTextIndex::layersKey(const std::vector<uint32_t>& mask)
+{
+    // Layers past the mask are visible, so trailing all visible words are left out
+    size_t size = mask.size();
+    while (size > 0 && mask[size - 1] == UINT32_MAX) {
+        size--;
+    }
+    if (size == 0) {
+        return 0;
+    }
+    return fnv1a(14695981039346656037ULL, (const uint8_t*) mask.data(), size * sizeof(uint32_t));
+}
+
+uint64_t MuPdfTextIndex::fileKey(int fd)
+{
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        return 0;
+    }
+    uint64_t size = (uint64_t) st.st_size;
+    uint64_t hash = fnv1a(14695981039346656037ULL, (const uint8_t*) &size, sizeof(size));
+    std::vector<uint8_t> buffer(TEXT_INDEX_HASH_CHUNK);
+    ssize_t head = pread(fd, buffer.data(), buffer.size(), 0);
+    if (head > 0) {
+        hash = fnv1a(hash, buffer.data(), (size_t) head);
+    }
+    if (size > TEXT_INDEX_HASH_CHUNK) {
+        ssize_t tail = pread(fd, buffer.data(), buffer.size(), size - TEXT_INDEX_HASH_CHUNK);
+        if (tail > 0) {
+            hash = fnv1a(hash, buffer.data(), (size_t) tail);
+        }
+    }
+    return hash;
+}
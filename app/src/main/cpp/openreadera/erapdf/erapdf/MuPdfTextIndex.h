@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#ifndef __MUPDF_TEXT_INDEX_H__
+#define __MUPDF_TEXT_INDEX_H__
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "StSearchUtils.h"
+
+/**
+ * Compact form of page hitboxes: texts are concatenated, xpointers are stored as numbers.
+ */
+class MuPdfPageText
+{
+public:
+    bool indexed = false;
+    std::wstring text;
+    /// End offset in text for every hitbox
+    std::vector<uint32_t> ends;
+    /// Left, right, top, bottom for every hitbox
+    std::vector<float> boxes;
+    /// Block, line, char for every hitbox, negative block for empty or unusual xpointer
+    std::vector<int32_t> ids;
+    std::map<uint32_t, std::string> xpointers;
+
+    void assign(uint32_t page, const std::vector<Hitbox>& hitboxes);
+    std::vector<Hitbox> toHitboxes(uint32_t page) const;
+    void clear();
+};
+
+/**
+ * Document text index: page hitboxes extracted once and reused by every search.
+ * Can be persisted to sidecar file keyed by document content hash.
+ */
+class MuPdfTextIndex
+{
+private:
+    std::vector<MuPdfPageText> pages;
+    uint32_t indexedCount = 0;
+    uint64_t key = 0;
+    bool dirty = false;
+
+public:
+    void reset(uint32_t pageCount, uint64_t key);
+    bool has(uint32_t page) const;
+    std::vector<Hitbox> get(uint32_t page) const;
+    void put(uint32_t page, const std::vector<Hitbox>& hitboxes);
+    /// Returns first page missing in the index, -1 if all pages are indexed
+    int nextMissing() const;
+
+    uint32_t getIndexedCount() const { return indexedCount; }
+    uint32_t getPageCount() const { return (uint32_t) pages.size(); }
+    uint64_t getKey() const { return key; }
+    bool isDirty() const { return dirty; }
+
+    bool load(const std::string& path);
+    bool save(const std::string& path);
+
+    /// Hash of file size and contents of its head and tail
+    static uint64_t fileKey(int fd);
+    /// Hash of layers mask, 0 when all layers are visible
+    static uint64_t layersKey(const std::vector<uint32_t>& mask);
+};
+
+#endif
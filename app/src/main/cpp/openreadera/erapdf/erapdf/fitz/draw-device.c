@@ -1771,6 +1771,7 @@ static fz_store_type fz_tile_store_type =
 	fz_keep_tile_key,
 	fz_drop_tile_key,
 	fz_cmp_tile_key,
+	FZ_STORE_IMAGE,
 #ifndef NDEBUG
 	fz_debug_tile
 #endif
@@ -34,6 +34,8 @@ struct fz_glyph_cache_s
 {
 	int refs;
 	int total;
+	/* EraPDF: configurable cache size */
+	int max;
 #ifndef NDEBUG
 	int num_evictions;
 	int evicted;
@@ -50,6 +52,7 @@ fz_new_glyph_cache_context(fz_context *ctx)
 
 	cache = fz_malloc_struct(ctx, fz_glyph_cache);
 	cache->total = 0;
+	cache->max = MAX_CACHE_SIZE;
 	cache->refs = 1;
 
 	ctx->glyph_cache = cache;
@@ -121,6 +124,31 @@ fz_drop_glyph_cache_context(fz_context *ctx)
 	fz_unlock(ctx, FZ_LOCK_GLYPHCACHE);
 }
 
+// EraPDF: configurable cache size >>>
+void
+fz_set_glyph_cache_max(fz_context *ctx, int max)
+{
+	fz_glyph_cache *cache = ctx->glyph_cache;
+
+	fz_lock(ctx, FZ_LOCK_GLYPHCACHE);
+	cache->max = max > 0 ? max : MAX_CACHE_SIZE;
+	while (cache->total > cache->max && cache->lru_tail)
+		drop_glyph_cache_entry(ctx, cache->lru_tail);
+	fz_unlock(ctx, FZ_LOCK_GLYPHCACHE);
+}
+
+int
+fz_glyph_cache_used(fz_context *ctx)
+{
+	int total;
+
+	fz_lock(ctx, FZ_LOCK_GLYPHCACHE);
+	total = ctx->glyph_cache->total;
+	fz_unlock(ctx, FZ_LOCK_GLYPHCACHE);
+	return total;
+}
+// EraPDF: configurable cache size <<<
+
 fz_glyph_cache *
 fz_keep_glyph_cache(fz_context *ctx)
 {
@@ -375,7 +403,7 @@ fz_render_glyph(fz_context *ctx, fz_font *font, int gid, fz_matrix *ctm, fz_colo
 				cache->lru_head = entry;
 
 				cache->total += fz_glyph_size(ctx, val);
-				while (cache->total > MAX_CACHE_SIZE)
+				while (cache->total > cache->max)
 				{
 #ifndef NDEBUG
 					cache->num_evictions++;
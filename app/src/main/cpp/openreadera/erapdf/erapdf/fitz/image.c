@@ -81,6 +81,7 @@ static fz_store_type fz_image_store_type =
 	fz_keep_image_key,
 	fz_drop_image_key,
 	fz_cmp_image_key,
+	FZ_STORE_IMAGE,
 #ifndef NDEBUG
 	fz_debug_image
 #endif
@@ -299,6 +300,28 @@ fz_image_get_pixmap(fz_context *ctx, fz_image *image, int w, int h)
 	case FZ_IMAGE_JXR:
 		tile = fz_load_jxr(ctx, image->buffer->buffer->data, image->buffer->buffer->len);
 		break;
+	// EraPDF: JPX decoded at the resolution level matching the wanted size >>>
+	case FZ_IMAGE_JPX:
+		indexed = fz_colorspace_is_indexed(ctx, image->colorspace);
+		fz_try(ctx)
+		{
+			tile = fz_load_jpx(ctx, image->buffer->buffer->data, image->buffer->buffer->len, image->colorspace, indexed, l2factor);
+		}
+		fz_catch(ctx)
+		{
+			/* Tiles may have fewer resolution levels than the main header says */
+			if (l2factor == 0)
+				fz_rethrow(ctx);
+			fz_warn(ctx, "retrying jpx decode at full resolution");
+			tile = fz_load_jpx(ctx, image->buffer->buffer->data, image->buffer->buffer->len, image->colorspace, indexed, 0);
+		}
+		if (!indexed && tile->n - 1 == image->n)
+			fz_decode_tile(ctx, tile, image->decode);
+		for (native_l2factor = 0; native_l2factor < l2factor && (image->w + (1 << native_l2factor) - 1) >> native_l2factor > tile->w; native_l2factor++);
+		if (l2factor > native_l2factor)
+			fz_subsample_pixmap(ctx, tile, l2factor - native_l2factor);
+		break;
+	// EraPDF: JPX decoded at the resolution level matching the wanted size <<<
 	case FZ_IMAGE_JPEG:
 		/* Scan JPEG stream and patch missing height values in header */
 		{
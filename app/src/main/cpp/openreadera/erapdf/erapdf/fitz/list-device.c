@@ -1335,6 +1335,16 @@ fz_drop_display_list(fz_context *ctx, fz_display_list *list)
 	fz_drop_storable(ctx, &list->storable);
 }
 
+// EraPDF: display list size >>>
+unsigned int
+fz_display_list_size(fz_context *ctx, fz_display_list *list)
+{
+	if (list == NULL)
+		return 0;
+	return sizeof(fz_display_list) + (unsigned int)list->max * sizeof(fz_display_node);
+}
+// EraPDF: display list size <<<
+
 void
 fz_run_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie,int pageindex)
 {
@@ -1989,7 +1999,7 @@ void checkPrevNodes(fz_context * ctx, darkmode_obj_page* page)
 	checkPrevNodesNewAlgo(ctx,page);
 }
 
-int count_analyze_objects(fz_context *ctx, fz_display_list *list, fz_device *dev, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie)
+int count_analyze_objects(fz_context *ctx, fz_display_list *list, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie)
 {
     int res = 0;
 
@@ -2205,12 +2215,15 @@ int count_analyze_objects(fz_context *ctx, fz_display_list *list, fz_device *dev
     return res;
 }
 
+/* EraPDF: images are classified by pixel statistics, a small copy is enough */
+#define DARKMODE_IMAGE_MAX_SIZE 256
+
 void
-fz_run_fake_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie, int pageindex)
+fz_run_fake_display_list(fz_context *ctx, fz_display_list *list, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie, int pageindex)
 {
 	ctx->darkmode_objs[pageindex].pagenum = pageindex;
 	ctx->darkmode_objs[pageindex].objcount = 0;
-	int objnum = count_analyze_objects(ctx,list,dev,top_ctm,scissor,cookie);
+	int objnum = count_analyze_objects(ctx,list,top_ctm,scissor,cookie);
 	ctx->darkmode_objs[pageindex].obj = malloc (sizeof (darkmode_obj) * objnum);
 
 	int objcounter = 0;
@@ -2469,6 +2482,12 @@ fz_run_fake_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev,
 
 								int dx = sqrtf(trans_ctm.a * trans_ctm.a + trans_ctm.b * trans_ctm.b);
 								int dy = sqrtf(trans_ctm.c * trans_ctm.c + trans_ctm.d * trans_ctm.d);
+								int dmax = fz_maxi(dx, dy);
+								if (dmax > DARKMODE_IMAGE_MAX_SIZE)
+								{
+									dx = fz_maxi(1, dx * DARKMODE_IMAGE_MAX_SIZE / dmax);
+									dy = fz_maxi(1, dy * DARKMODE_IMAGE_MAX_SIZE / dmax);
+								}
 								fz_pixmap *pixmap = fz_new_pixmap_from_image(ctx, *(fz_image **) node, dx, dy);
 
 								int invert = 0;
@@ -2493,7 +2512,10 @@ fz_run_fake_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev,
 	                                    check = pixmap;
                                     }
                                     invert = fz_count_pixmap_needs_invert(ctx, check);
+                                    if (check != pixmap)
+                                        fz_drop_pixmap(ctx, check);
                                 }
+                                fz_drop_pixmap(ctx, pixmap);
 								obj->invert  = invert;
 								obj->node    = node;
 								obj->type    = FZ_CMD_FILL_IMAGE;
@@ -9,7 +9,6 @@
 #endif
 
 #include <openjpeg.h>
-#define MAXSIZE 512
 
 static void fz_opj_error_callback(const char *msg, void *client_data)
 {
@@ -80,7 +79,65 @@ static inline unsigned int read_value(const unsigned char *data, int bytes)
 	return value;
 }
 
-void getJpxDims(fz_context *ctx, unsigned char *data, int size, int indexed, int *width, int *height, int *numcomps)
+// EraPDF: patch from Sumatra PDF >>>
+/* SumatraPDF: extract image resolution (TODO: make openjpeg do this) */
+static void jpx_read_resolution(fz_context *ctx, unsigned char *data, int size, int *xres, int *yres)
+{
+	unsigned char *base = data;
+	int rest = size, ix = 0, level = 0;
+	while (ix < rest - 8)
+	{
+		int lbox = read_value(base + ix, 4);
+		unsigned int tbox = read_value(base + ix + 4, 4);
+		if (lbox < 8 || lbox > rest - ix)
+		{
+			fz_warn(ctx, "impossibly small or large JP2 box (%x, %d)", tbox, lbox);
+			break;
+		}
+		if (level == 0 && tbox == 0x6A703268 /* jp2h */ || level == 1 && tbox == 0x72657320 /* res  */)
+		{
+			base += ix + 8;
+			rest = lbox - 8;
+			ix = 0;
+			level++;
+		}
+		else if (level == 2 && tbox == 0x72657363 /* resc */ && lbox == 18 && rest - ix >= 18)
+		{
+			int vrn = read_value((base += ix + 8), 2);
+			int vrd = read_value(base + 2, 2);
+			int hrn = read_value(base + 4, 2);
+			int hrd = read_value(base + 6, 2);
+			int vre = (char)base[8], hre = (char)base[9];
+			*xres = (int)((float)hrn / hrd * pow(10, hre - 2) * 2.54f);
+			*yres = (int)((float)vrn / vrd * pow(10, vre - 2) * 2.54f);
+			if (*xres <= 0 || *yres <= 0)
+			{
+				fz_warn(ctx, "invalid image resolution (%d, %d)", *xres, *yres);
+				*xres = *yres = 96;
+			}
+			break;
+		}
+		else
+		{
+			ix += lbox;
+		}
+	}
+}
+// EraPDF: patch from Sumatra PDF <<<
+
+/* Number of color components in the pixmap made of the decoded components */
+static int jpx_color_comps(OPJ_COLOR_SPACE color_space, int numcomps, int *alpha)
+{
+	*alpha = 1;
+	if (color_space == OPJ_CLRSPC_SRGB && numcomps == 4) return 3;
+	if (color_space == OPJ_CLRSPC_SYCC && numcomps == 4) return 3;
+	if (numcomps == 2) return 1;
+	if (numcomps > 4) return 4;
+	*alpha = 0;
+	return numcomps;
+}
+
+void getJpxDims(fz_context *ctx, unsigned char *data, int size, int indexed, int *width, int *height, int *numcomps, OPJ_COLOR_SPACE *color_space)
 {
 	opj_dparameters_t params;
 	opj_codec_t *codec;
@@ -138,13 +195,37 @@ void getJpxDims(fz_context *ctx, unsigned char *data, int size, int indexed, int
 	*width = jpx->x1 - jpx->x0;
 	*height= jpx->y1 - jpx->y0;
 	*numcomps = jpx->numcomps;
+	if (color_space)
+		*color_space = jpx->color_space;
 	opj_destroy_codec(codec);
 	opj_stream_destroy(stream);
 	opj_image_destroy(jpx);
 }
 
+void
+fz_load_jpx_info(fz_context *ctx, unsigned char *data, int size, int indexed, int *wp, int *hp, int *xresp, int *yresp, fz_colorspace **cspacep)
+{
+	OPJ_COLOR_SPACE color_space;
+	int numcomps, n, a;
+
+	getJpxDims(ctx, data, size, indexed, wp, hp, &numcomps, &color_space);
+	n = jpx_color_comps(color_space, numcomps, &a);
+	if (a && n == 4)
+		n = 3;
+	switch (n)
+	{
+	case 1: *cspacep = fz_device_gray(ctx); break;
+	case 3: *cspacep = fz_device_rgb(ctx); break;
+	case 4: *cspacep = fz_device_cmyk(ctx); break;
+	default: fz_throw(ctx, FZ_ERROR_GENERIC, "unsupported number of jpx components: %d", numcomps);
+	}
+	*xresp = *yresp = 96;
+	if (!(data[0] == 0xFF && data[1] == 0x4F))
+		jpx_read_resolution(ctx, data, size, xresp, yresp);
+}
+
 fz_pixmap *
-fz_load_jpx(fz_context *ctx, unsigned char *data, int size, fz_colorspace *defcs, int indexed)
+fz_load_jpx(fz_context *ctx, unsigned char *data, int size, fz_colorspace *defcs, int indexed, int l2factor)
 {
 	fz_pixmap *img;
 	opj_dparameters_t params;
@@ -175,53 +256,7 @@ fz_load_jpx(fz_context *ctx, unsigned char *data, int size, fz_colorspace *defcs
 
 	//opj_codec_set_threads(codec,4); // if not called - creates %cpu number% threads
 
-	if(ctx->previewmode == 1)
-	{
-		//default vals
-		params.cp_layer = 1;
-		params.cp_reduce = 2;
-
-		int width = 0;
-		int height = 0;
-		int temp_n = 0;
-		getJpxDims(ctx,data,size,indexed,&width,&height,&temp_n);
-		//LE("width = %d, height = %d",width,height);
-
-		int maxdim = fz_maxi(width,height);
-		unsigned int reducefactor = 0;
-		int maxdim_temp = maxdim;
-		while (maxdim_temp > MAXSIZE)
-		{
-			maxdim_temp = maxdim;
-			reducefactor++;
-			// + 0.5 is to fix double precision storage error
-			// for example:
-			// pow(2,5) might be stored as 24.9999999 or 25.0000000001 depending on compiler,
-			// because the return type is double. When assigned to int,
-			// 25.0000000001 becomes 25 but 24.9999999 will give output 24.
-			maxdim_temp = maxdim_temp / (int)(pow(2,reducefactor)+0.5f);
-		}
-
-		params.cp_reduce = (reducefactor > 2) ? reducefactor: 2;
-
-		int size = width*height*temp_n;
-		if (ctx->preview_heavy_image == 0 && size > MAXSIZE * MAXSIZE * 3 )
-		{
-			ctx->preview_heavy_image = 1;
-			/*
-			   LE("new w = %d, new h = %d",
-					width  / (int)(pow(2,params.cp_reduce)+0.5),
-					height / (int)(pow(2,params.cp_reduce)+0.5));
-			*/
-		}
-		else
-		{
-			//LE("JPG Image is not too big, so full decoding now : %dx%d*%d = %0.2f Kbytes",width,height,temp_n,size/1000.0);
-			params.cp_layer = 0;
-			params.cp_reduce = 0;
-		}
-	}
-	else if (ctx->previewmode == 2) // SUPERFAST mode for page statistics extraction. All images are flat white.
+	if (ctx->previewmode == 2) // SUPERFAST mode for page statistics extraction. All images are flat white.
 	{
 		int temp_w = 10;
 		int temp_h = 10;
@@ -259,6 +294,21 @@ fz_load_jpx(fz_context *ctx, unsigned char *data, int size, fz_colorspace *defcs
 		fz_throw(ctx, FZ_ERROR_GENERIC, "Failed to read JPX header");
 	}
 
+	// EraPDF: skip the resolution levels finer than the wanted size >>>
+	if (l2factor > 0)
+	{
+		opj_codestream_info_v2_t *info = opj_get_cstr_info(codec);
+		if (info)
+		{
+			for (k = 0; k < (int)info->nbcomps; k++)
+				l2factor = fz_mini(l2factor, (int)info->m_default_tile_info.tccp_info[k].numresolutions - 1);
+			opj_destroy_cstr_info(&info);
+			if (l2factor > 0)
+				opj_set_decoded_resolution_factor(codec, l2factor);
+		}
+	}
+	// EraPDF: skip the resolution levels finer than the wanted size <<<
+
 	//LE("JPX x0 = %d x1 = %d y0 = %d y1 = %d",jpx->x0, jpx->x1, jpx->y0, jpx->y1)
 	//opj_set_decode_area(codec, jpx, jpx->x0,jpx->y0,jpx->x1/2,jpx->y1/2);
 	if (!(opj_decode(codec, stream, jpx) && opj_end_decompress(codec,stream)))
@@ -306,11 +356,7 @@ fz_load_jpx(fz_context *ctx, unsigned char *data, int size, fz_colorspace *defcs
 	depth = jpx->comps[0].prec;
 	sgnd = jpx->comps[0].sgnd;
 
-	if (jpx->color_space == OPJ_CLRSPC_SRGB && n == 4) { n = 3; a = 1; }
-	else if (jpx->color_space == OPJ_CLRSPC_SYCC && n == 4) { n = 3; a = 1; }
-	else if (n == 2) { n = 1; a = 1; }
-	else if (n > 4) { n = 4; a = 1; }
-	else { a = 0; }
+	n = jpx_color_comps(jpx->color_space, n, &a);
 
 	if (defcs)
 	{
@@ -379,49 +425,8 @@ fz_load_jpx(fz_context *ctx, unsigned char *data, int size, fz_colorspace *defcs
 	}
 
 	// EraPDF: patch from Sumatra PDF >>>
-	/* SumatraPDF: extract image resolution (TODO: make openjpeg do this) */
 	if (format == OPJ_CODEC_JP2)
-	{
-		unsigned char *base = data;
-		int rest = size, ix = 0, level = 0;
-		while (ix < rest - 8)
-		{
-			int lbox = read_value(base + ix, 4);
-			unsigned int tbox = read_value(base + ix + 4, 4);
-			if (lbox < 8 || lbox > rest - ix)
-			{
-				fz_warn(ctx, "impossibly small or large JP2 box (%x, %d)", tbox, lbox);
-				break;
-			}
-			if (level == 0 && tbox == 0x6A703268 /* jp2h */ || level == 1 && tbox == 0x72657320 /* res  */)
-			{
-				base += ix + 8;
-				rest = lbox - 8;
-				ix = 0;
-				level++;
-			}
-			else if (level == 2 && tbox == 0x72657363 /* resc */ && lbox == 18 && rest - ix >= 18)
-			{
-				int vrn = read_value((base += ix + 8), 2);
-				int vrd = read_value(base + 2, 2);
-				int hrn = read_value(base + 4, 2);
-				int hrd = read_value(base + 6, 2);
-				int vre = (char)base[8], hre = (char)base[9];
-				img->xres = (int)((float)hrn / hrd * pow(10, hre - 2) * 2.54f);
-				img->yres = (int)((float)vrn / vrd * pow(10, vre - 2) * 2.54f);
-				if (img->xres <= 0 || img->yres <= 0)
-				{
-					fz_warn(ctx, "invalid image resolution (%d, %d)", img->xres, img->yres);
-					img->xres = img->yres = 96;
-				}
-				break;
-			}
-			else
-			{
-				ix += lbox;
-			}
-		}
-	}
+		jpx_read_resolution(ctx, data, size, &img->xres, &img->yres);
 	// EraPDF: patch from Sumatra PDF <<<
 
 	return img;
@@ -29,6 +29,11 @@ struct fz_store_s
 	/* We keep track of the size of the store, and keep it below max. */
 	unsigned int max;
 	unsigned int size;
+
+	/* EraPDF: the same per category, zero category max means no limit
+	 * of its own. */
+	unsigned int category_max[FZ_STORE_CATEGORIES];
+	unsigned int category_size[FZ_STORE_CATEGORIES];
 };
 
 void
@@ -80,6 +85,7 @@ evict(fz_context *ctx, fz_item *item)
 	int drop;
 
 	store->size -= item->size;
+	store->category_size[item->type->category] -= item->size;
 	/* Unlink from the linked list */
 	if (item->next)
 		item->next->prev = item->prev;
@@ -108,8 +114,10 @@ evict(fz_context *ctx, fz_item *item)
 	fz_lock(ctx, FZ_LOCK_ALLOC);
 }
 
+/* EraPDF: category limits eviction to items of one category, negative
+ * category allows any item to go. */
 static int
-ensure_space(fz_context *ctx, unsigned int tofree)
+ensure_space(fz_context *ctx, unsigned int tofree, int category)
 {
 	fz_item *item, *prev;
 	unsigned int count;
@@ -122,7 +130,7 @@ ensure_space(fz_context *ctx, unsigned int tofree)
 	count = 0;
 	for (item = store->tail; item; item = item->prev)
 	{
-		if (item->val->refs == 1)
+		if (item->val->refs == 1 && (category < 0 || item->type->category == category))
 		{
 			count += item->size;
 			if (count >= tofree)
@@ -141,7 +149,7 @@ ensure_space(fz_context *ctx, unsigned int tofree)
 	for (item = store->tail; item; item = prev)
 	{
 		prev = item->prev;
-		if (item->val->refs == 1)
+		if (item->val->refs == 1 && (category < 0 || item->type->category == category))
 		{
 			/* Free this item. Evict has to drop the lock to
 			 * manage that, which could cause prev to be removed
@@ -170,6 +178,43 @@ ensure_space(fz_context *ctx, unsigned int tofree)
 	return count;
 }
 
+/* EraPDF: makes room for itemsize bytes within the store and within its
+ * category, returns zero if it can not be done. May drop, then retake
+ * the lock. */
+static int
+make_space(fz_context *ctx, unsigned int itemsize, int category)
+{
+	fz_store *store = ctx->store;
+	unsigned int size, max;
+	int saved;
+
+	/* If we haven't got an infinite store, check for space within it */
+	if (store->max != FZ_STORE_UNLIMITED)
+	{
+		size = store->size + itemsize;
+		while (size > store->max)
+		{
+			saved = ensure_space(ctx, size - store->max, -1);
+			if (saved == 0)
+				return 0;
+			size -= saved;
+		}
+	}
+	max = store->category_max[category];
+	if (max != 0)
+	{
+		size = store->category_size[category] + itemsize;
+		while (size > max)
+		{
+			saved = ensure_space(ctx, size - max, category);
+			if (saved == 0)
+				return 0;
+			size -= saved;
+		}
+	}
+	return 1;
+}
+
 static void
 touch(fz_store *store, fz_item *item)
 {
@@ -199,7 +244,6 @@ void *
 fz_store_item(fz_context *ctx, void *key, void *val_, unsigned int itemsize, fz_store_type *type)
 {
 	fz_item *item = NULL;
-	unsigned int size;
 	fz_storable *val = (fz_storable *)val_;
 	fz_store *store = ctx->store;
 	fz_store_hash hash = { NULL };
@@ -217,6 +261,8 @@ fz_store_item(fz_context *ctx, void *key, void *val_, unsigned int itemsize, fz_
 		 * possibly have in the store. Just give up now. */
 		return NULL;
 	}
+	if (store->category_max[type->category] != 0 && store->category_max[type->category] < itemsize)
+		return NULL;
 
 	/* If we fail for any reason, we swallow the exception and continue.
 	 * All that the above program will see is that we failed to store
@@ -286,40 +332,30 @@ fz_store_item(fz_context *ctx, void *key, void *val_, unsigned int itemsize, fz_
 	/* Now bump the ref */
 	if (val->refs > 0)
 		val->refs++;
-	/* If we haven't got an infinite store, check for space within it */
-	if (store->max != FZ_STORE_UNLIMITED)
+	/* make_space may drop, then retake the lock */
+	if (!make_space(ctx, itemsize, type->category))
 	{
-		size = store->size + itemsize;
-		while (size > store->max)
+		/* Failed to free any space. */
+		/* If we are using the hash table, then we've already
+		 * inserted item - remove it. If someone else has already
+		 * picked up a reference to item, then we cannot remove it.
+		 * Leave it in the store, and we'll live with being over
+		 * budget. We know this is the case, if it's in the linked
+		 * list. */
+		if (!use_hash || item->next == item)
 		{
-			/* ensure_space may drop, then retake the lock */
-			int saved = ensure_space(ctx, size - store->max);
-			if (saved == 0)
-			{
-				/* Failed to free any space. */
-				/* If we are using the hash table, then we've already
-				 * inserted item - remove it. */
-				if (use_hash)
-				{
-					/* If someone else has already picked up a reference
-					 * to item, then we cannot remove it. Leave it in the
-					 * store, and we'll live with being over budget. We
-					 * know this is the case, if it's in the linked list. */
-					if (item->next != item)
-						break;
-					fz_hash_remove_fast(ctx, store->hash, &hash, pos);
-				}
-				fz_unlock(ctx, FZ_LOCK_ALLOC);
-				fz_free(ctx, item);
-				type->drop_key(ctx, key);
-				if (val->refs > 0)
-					val->refs--;
-				return NULL;
-			}
-			size -= saved;
+			if (use_hash)
+				fz_hash_remove_fast(ctx, store->hash, &hash, pos);
+			fz_unlock(ctx, FZ_LOCK_ALLOC);
+			fz_free(ctx, item);
+			type->drop_key(ctx, key);
+			if (val->refs > 0)
+				val->refs--;
+			return NULL;
 		}
 	}
 	store->size += itemsize;
+	store->category_size[type->category] += itemsize;
 
 	/* Regardless of whether it's indexed, it goes into the linked list */
 	touch(store, item);
@@ -426,6 +462,9 @@ fz_remove_item(fz_context *ctx, fz_store_drop_fn *drop, void *key, fz_store_type
 				item->prev->next = item->next;
 			else
 				store->head = item->next;
+			/* EraPDF: listed items are counted in the store size */
+			store->size -= item->size;
+			store->category_size[item->type->category] -= item->size;
 		}
 		dodrop = (item->val->refs > 0 && --item->val->refs == 0);
 		fz_unlock(ctx, FZ_LOCK_ALLOC);
@@ -534,7 +573,7 @@ fz_print_store(fz_context *ctx, FILE *out)
 /* This is now an n^2 algorithm - not ideal, but it'll only be bad if we are
  * actually managing to scavenge lots of blocks back. */
 static int
-scavenge(fz_context *ctx, unsigned int tofree)
+scavenge(fz_context *ctx, unsigned int tofree, int category)
 {
 	fz_store *store = ctx->store;
 	unsigned int count = 0;
@@ -544,7 +583,7 @@ scavenge(fz_context *ctx, unsigned int tofree)
 	for (item = store->tail; item; item = prev)
 	{
 		prev = item->prev;
-		if (item->val->refs == 1)
+		if (item->val->refs == 1 && (category < 0 || item->type->category == category))
 		{
 			/* Free this item */
 			count += item->size;
@@ -599,7 +638,7 @@ int fz_store_scavenge(fz_context *ctx, unsigned int size, int *phase)
 		else
 			tofree = size + store->size - max;
 
-		if (scavenge(ctx, tofree))
+		if (scavenge(ctx, tofree, -1))
 		{
 #ifdef DEBUG_SCAVENGING
 			printf("scavenged: store=%d\n", store->size);
@@ -643,7 +682,7 @@ fz_shrink_store(fz_context *ctx, unsigned int percent)
 
 	new_size = (unsigned int)(((uint64_t)store->size * percent) / 100);
 	if (store->size > new_size)
-		scavenge(ctx, store->size - new_size);
+		scavenge(ctx, store->size - new_size, -1);
 
 	success = (store->size <= new_size) ? 1 : 0;
 	fz_unlock(ctx, FZ_LOCK_ALLOC);
@@ -653,3 +692,66 @@ fz_shrink_store(fz_context *ctx, unsigned int percent)
 
 	return success;
 }
+
+// EraPDF: store categories >>>
+int
+fz_trim_store(fz_context *ctx, unsigned int max)
+{
+	int success;
+	fz_store *store;
+
+	if (ctx == NULL)
+		return 0;
+
+	store = ctx->store;
+	if (store == NULL)
+		return 0;
+
+	fz_lock(ctx, FZ_LOCK_ALLOC);
+	if (store->size > max)
+		scavenge(ctx, store->size - max, -1);
+	success = (store->size <= max) ? 1 : 0;
+	fz_unlock(ctx, FZ_LOCK_ALLOC);
+
+	return success;
+}
+
+void
+fz_set_store_category_max(fz_context *ctx, int category, unsigned int max)
+{
+	fz_store *store;
+
+	if (ctx == NULL || category < 0 || category >= FZ_STORE_CATEGORIES)
+		return;
+
+	store = ctx->store;
+	if (store == NULL)
+		return;
+
+	fz_lock(ctx, FZ_LOCK_ALLOC);
+	store->category_max[category] = max;
+	if (max != 0 && store->category_size[category] > max)
+		scavenge(ctx, store->category_size[category] - max, category);
+	fz_unlock(ctx, FZ_LOCK_ALLOC);
+}
+
+unsigned int
+fz_store_used(fz_context *ctx, int category)
+{
+	fz_store *store;
+	unsigned int size;
+
+	if (ctx == NULL || category >= FZ_STORE_CATEGORIES)
+		return 0;
+
+	store = ctx->store;
+	if (store == NULL)
+		return 0;
+
+	fz_lock(ctx, FZ_LOCK_ALLOC);
+	size = category < 0 ? store->size : store->category_size[category];
+	fz_unlock(ctx, FZ_LOCK_ALLOC);
+
+	return size;
+}
+// EraPDF: store categories <<<
@@ -1,5 +1,10 @@
 #include "mupdf/fitz.h"
 
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 fz_stream *
 fz_new_stream(fz_context *ctx, void *state, fz_stream_next_fn *next, fz_stream_close_fn *close)
 {
@@ -187,6 +192,136 @@ fz_open_file_w(fz_context *ctx, const wchar_t *name)
 }
 #endif
 
+// EraPDF: memory mapped file stream >>>
+#if !defined(_WIN32) && !defined(_WIN64)
+
+/*
+	The whole file is mapped once and the stream window always spans
+	from the read position to the end of the mapping, so reads and
+	seeks never reach the kernel except for page faults.
+*/
+typedef struct fz_mmap_stream_s
+{
+	int file;
+	unsigned char *data;
+	int len;
+	int end; /* Mapping offset of stm->wp */
+} fz_mmap_stream;
+
+static int next_mmap(fz_context *ctx, fz_stream *stm, int n)
+{
+	fz_mmap_stream *state = stm->state;
+
+	if (state->end >= state->len)
+		return EOF;
+	stm->rp = state->data + state->end;
+	stm->wp = state->data + state->len;
+	stm->pos += state->len - state->end;
+	state->end = state->len;
+	return *stm->rp++;
+}
+
+static void seek_mmap(fz_context *ctx, fz_stream *stm, int offset, int whence)
+{
+	fz_mmap_stream *state = stm->state;
+	/// EraPDF: corrupted files with garbage on start >>>
+	if (whence == SEEK_SET)
+		offset += ctx->erapdf_file_stream_offset;
+	/// EraPDF: corrupted files with garbage on start <<<
+	else if (whence == SEEK_END)
+		offset += state->len;
+	if (offset < 0)
+		offset = 0;
+	/* Like lseek, seeking past the end is allowed and reads EOF */
+	stm->rp = state->data + fz_mini(offset, state->len);
+	stm->wp = state->data + state->len;
+	state->end = state->len;
+	/// EraPDF: corrupted files with garbage on start >>>
+	stm->pos = fz_maxi(offset, state->len) - ctx->erapdf_file_stream_offset;
+	/// EraPDF: corrupted files with garbage on start <<<
+}
+
+static void close_mmap(fz_context *ctx, void *state_)
+{
+	fz_mmap_stream *state = state_;
+	if (munmap(state->data, state->len) < 0)
+		fz_warn(ctx, "munmap error: %s", strerror(errno));
+	if (close(state->file) < 0)
+		fz_warn(ctx, "close error: %s", strerror(errno));
+	fz_free(ctx, state);
+}
+
+static int meta_mmap(fz_context *ctx, fz_stream *stm, int key, int size, void *ptr)
+{
+	fz_mmap_stream *state = (fz_mmap_stream *)stm->state;
+	switch(key)
+	{
+	case FZ_STREAM_META_PROGRESSIVE:
+		return 0;
+	case FZ_STREAM_META_LENGTH:
+		return state->len;
+	case FZ_STREAM_META_ACCESS:
+		{
+			int advice = MADV_NORMAL;
+			if (size == FZ_STREAM_ACCESS_SEQUENTIAL)
+				advice = MADV_SEQUENTIAL;
+			else if (size == FZ_STREAM_ACCESS_RANDOM)
+				advice = MADV_RANDOM;
+			return madvise(state->data, state->len, advice);
+		}
+	}
+	return -1;
+}
+
+#endif
+
+fz_stream *
+fz_open_fd_mmap(fz_context *ctx, int fd)
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	fz_stream *stm;
+	fz_mmap_stream *state;
+	struct stat info;
+	void *data;
+
+	/* Pipes, empty and huge files are left to the read() based stream */
+	if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode) || info.st_size <= 0 || info.st_size > INT_MAX)
+		return fz_open_fd(ctx, fd);
+	data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (data == MAP_FAILED)
+	{
+		fz_warn(ctx, "cannot mmap file, reading it instead: %s", strerror(errno));
+		return fz_open_fd(ctx, fd);
+	}
+
+	fz_try(ctx)
+	{
+		state = fz_malloc_struct(ctx, fz_mmap_stream);
+	}
+	fz_catch(ctx)
+	{
+		munmap(data, (size_t)info.st_size);
+		close(fd);
+		fz_rethrow(ctx);
+	}
+	state->file = fd;
+	state->data = data;
+	state->len = (int)info.st_size;
+	state->end = 0;
+
+	stm = fz_new_stream(ctx, state, next_mmap, close_mmap);
+	stm->seek = seek_mmap;
+	stm->meta = meta_mmap;
+	stm->rp = state->data;
+	stm->wp = state->data;
+
+	return stm;
+#else
+	return fz_open_fd(ctx, fd);
+#endif
+}
+// EraPDF: memory mapped file stream <<<
+
 /* Memory stream */
 
 static int next_buffer(fz_context *ctx, fz_stream *stm, int max)
@@ -196,7 +196,6 @@ struct fz_context_s
 	int erapdf_reparing;
 	int previewmode;
 	int flag_interpolate_images;
-	int preview_heavy_image;
     darkmode_obj_page *darkmode_objs;
 	fz_rect ignore_rects[100];
 	int ignore_rects_num;
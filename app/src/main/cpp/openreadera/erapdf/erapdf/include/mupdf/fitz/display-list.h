@@ -72,7 +72,7 @@ fz_device *fz_new_list_device(fz_context *ctx, fz_display_list *list);
 	cookie are continually updated while the page is being run.
 */
 void fz_run_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev, const fz_matrix *ctm, const fz_rect *area, fz_cookie *cookie, int pageindex);
-void fz_run_fake_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie, int pageindex);
+void fz_run_fake_display_list(fz_context *ctx, fz_display_list *list, const fz_matrix *top_ctm, const fz_rect *scissor, fz_cookie *cookie, int pageindex);
 
 //void fz_analyze_display_list(fz_context *ctx, fz_display_list *list, fz_device *dev, const fz_matrix *ctm, const fz_rect *area, fz_cookie *cookie, fz_rect* result, int* result_rectnum);
 
@@ -91,4 +91,10 @@ fz_display_list *fz_keep_display_list(fz_context *ctx, fz_display_list *list);
 */
 void fz_drop_display_list(fz_context *ctx, fz_display_list *list);
 
+/*
+	EraPDF: fz_display_list_size: Bytes taken by the nodes of a display
+	list. Text, images and shadings it references are not counted.
+*/
+unsigned int fz_display_list_size(fz_context *ctx, fz_display_list *list);
+
 #endif
@@ -17,6 +17,9 @@ void fz_new_glyph_cache_context(fz_context *ctx);
 fz_glyph_cache *fz_keep_glyph_cache(fz_context *ctx);
 void fz_drop_glyph_cache_context(fz_context *ctx);
 void fz_purge_glyph_cache(fz_context *ctx);
+/* EraPDF: cache size in bytes, least recently used glyphs above it are evicted, 0 restores the default */
+void fz_set_glyph_cache_max(fz_context *ctx, int max);
+int fz_glyph_cache_used(fz_context *ctx);
 
 fz_path *fz_outline_ft_glyph(fz_context *ctx, fz_font *font, int gid, const fz_matrix *trm);
 fz_path *fz_outline_glyph(fz_context *ctx, fz_font *font, int gid, const fz_matrix *ctm);
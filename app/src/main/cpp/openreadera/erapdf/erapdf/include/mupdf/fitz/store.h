@@ -86,12 +86,28 @@ struct fz_store_hash_s
 
 typedef struct fz_store_type_s fz_store_type;
 
+// EraPDF: store categories >>>
+/*
+	Store categories: every category may be given a budget of its own
+	within the store, so that one kind of objects does not evict all
+	the others.
+*/
+enum
+{
+	FZ_STORE_RESOURCE, /* colorspaces, functions, shadings, forms, cmaps */
+	FZ_STORE_IMAGE, /* images, decoded images and rendered tiles */
+	FZ_STORE_FONT,
+	FZ_STORE_CATEGORIES
+};
+// EraPDF: store categories <<<
+
 struct fz_store_type_s
 {
 	int (*make_hash_key)(fz_context *ctx, fz_store_hash *, void *);
 	void *(*keep_key)(fz_context *,void *);
 	void (*drop_key)(fz_context *,void *);
 	int (*cmp_key)(fz_context *ctx, void *, void *);
+	int category;
 #ifndef NDEBUG
 	void (*debug)(fz_context *ctx, FILE *, void *);
 #endif
@@ -194,6 +210,30 @@ int fz_store_scavenge(fz_context *ctx, unsigned int size, int *phase);
 */
 int fz_shrink_store(fz_context *ctx, unsigned int percent);
 
+// EraPDF: store categories >>>
+/*
+	fz_trim_store: Evict least recently used items from the store until
+	the total size of the objects in the store is at most max bytes.
+
+	Returns non zero if we managed to free enough memory, zero otherwise.
+*/
+int fz_trim_store(fz_context *ctx, unsigned int max);
+
+/*
+	fz_set_store_category_max: Limit the size of the objects of one
+	category in the store, evicting the least recently used ones above
+	the limit. Zero max leaves the category limited by the store size
+	only.
+*/
+void fz_set_store_category_max(fz_context *ctx, int category, unsigned int max);
+
+/*
+	fz_store_used: Total size of the objects of given category in the
+	store, or of all objects for negative category.
+*/
+unsigned int fz_store_used(fz_context *ctx, int category);
+// EraPDF: store categories <<<
+
 /*
 	fz_print_store: Dump the contents of the store for debugging.
 */
@@ -52,6 +52,17 @@ fz_stream *fz_open_file_w(fz_context *ctx, const wchar_t *filename);
 */
 fz_stream *fz_open_fd(fz_context *ctx, int file);
 
+/*
+	fz_open_fd_mmap: Wrap an open file descriptor in a stream
+	reading straight from a memory mapping of the whole file.
+
+	Takes ownership of the file descriptor like fz_open_fd and
+	falls back to it for descriptors that cannot be mapped. Use
+	FZ_STREAM_META_ACCESS to tell the kernel how the file is
+	about to be read.
+*/
+fz_stream *fz_open_fd_mmap(fz_context *ctx, int file);
+
 /*
 	fz_open_memory: Open a block of memory as a stream.
 
@@ -150,7 +161,16 @@ fz_buffer *fz_read_file(fz_context *ctx, const char *filename);
 enum
 {
 	FZ_STREAM_META_PROGRESSIVE = 1,
-	FZ_STREAM_META_LENGTH = 2
+	FZ_STREAM_META_LENGTH = 2,
+	/* EraPDF: access pattern hint, passed as size */
+	FZ_STREAM_META_ACCESS = 3
+};
+
+enum
+{
+	FZ_STREAM_ACCESS_NORMAL = 0,
+	FZ_STREAM_ACCESS_SEQUENTIAL = 1,
+	FZ_STREAM_ACCESS_RANDOM = 2
 };
 
 int fz_stream_meta(fz_context *ctx, fz_stream *stm, int key, int size, void *ptr);
@@ -123,6 +123,8 @@ struct pdf_ocg_descriptor_s
 	int len;
 	pdf_ocg_entry *ocgs;
 	pdf_obj *intent;
+	/* EraPDF: number of optional content checks, tells which pages depend on layers */
+	int lookups;
 };
 
 /*
@@ -5,6 +5,8 @@
  * PDF interface to store
  */
 void pdf_store_item(fz_context *ctx, pdf_obj *key, void *val, unsigned int itemsize);
+/* EraPDF: category is one of FZ_STORE_RESOURCE, FZ_STORE_IMAGE, FZ_STORE_FONT */
+void pdf_store_item_category(fz_context *ctx, pdf_obj *key, void *val, unsigned int itemsize, int category);
 void *pdf_find_item(fz_context *ctx, fz_store_drop_fn *drop, pdf_obj *key);
 void pdf_remove_item(fz_context *ctx, fz_store_drop_fn *drop, pdf_obj *key);
 
@@ -861,6 +861,7 @@ static fz_store_type hail_mary_store_type =
 	hail_mary_keep_key,
 	hail_mary_drop_key,
 	hail_mary_cmp_key,
+	FZ_STORE_FONT,
 #ifndef NDEBUG
 	hail_mary_debug_key
 #endif
@@ -1313,7 +1314,7 @@ pdf_load_font(fz_context *ctx, pdf_document *doc, pdf_obj *rdb, pdf_obj *dict, i
 	if (fontdesc->font->ft_substitute && !fontdesc->to_ttf_cmap)
 		pdf_make_width_table(ctx, fontdesc);
 
-	pdf_store_item(ctx, dict, fontdesc, fontdesc->size);
+	pdf_store_item_category(ctx, dict, fontdesc, fontdesc->size, FZ_STORE_FONT);
 
 	if (type3)
 		pdf_load_type3_glyphs(ctx, doc, fontdesc, nested_depth);
@@ -217,11 +217,13 @@ pdf_load_jpx(fz_context *ctx, pdf_document *doc, pdf_obj *dict, int forcemask)
 	int indexed = 0;
 	fz_image *mask = NULL;
 	fz_image *img = NULL;
+	fz_compressed_buffer *bc = NULL;
 
 	fz_var(pix);
 	fz_var(buf);
 	fz_var(colorspace);
 	fz_var(mask);
+	fz_var(bc);
 
 	buf = pdf_load_stream(ctx, doc, pdf_to_num(ctx, dict), pdf_to_gen(ctx, dict));
 
@@ -235,7 +237,42 @@ pdf_load_jpx(fz_context *ctx, pdf_document *doc, pdf_obj *dict, int forcemask)
 			indexed = fz_colorspace_is_indexed(ctx, colorspace);
 		}
 
-		pix = fz_load_jpx(ctx, buf->data, buf->len, colorspace, indexed);
+		// EraPDF: keep JPX compressed and decode it at the drawn size >>>
+		/* Soft masks get converted right away, see pdf_load_image_imp */
+		if (!forcemask)
+		{
+			fz_colorspace *jpxcs;
+			fz_compressed_buffer *jpxbc;
+			float decode[FZ_MAX_COLORS * 2];
+			int w, h, xres, yres, i;
+
+			fz_load_jpx_info(ctx, buf->data, buf->len, indexed, &w, &h, &xres, &yres, &jpxcs);
+			if (colorspace && colorspace->n == jpxcs->n)
+				jpxcs = colorspace;
+
+			obj = pdf_dict_geta(ctx, dict, PDF_NAME_SMask, PDF_NAME_Mask);
+			if (pdf_is_dict(ctx, obj))
+				mask = pdf_load_image_imp(ctx, doc, NULL, obj, NULL, 1);
+
+			obj = pdf_dict_geta(ctx, dict, PDF_NAME_Decode, PDF_NAME_D);
+			if (obj && !indexed)
+				for (i = 0; i < jpxcs->n * 2; i++)
+					decode[i] = pdf_to_real(ctx, pdf_array_get(ctx, obj, i));
+
+			bc = fz_malloc_struct(ctx, fz_compressed_buffer);
+			bc->buffer = fz_keep_buffer(ctx, buf);
+			bc->params.type = FZ_IMAGE_JPX;
+			bc->params.u.jpx.smask_in_data = pdf_to_int(ctx, pdf_dict_get(ctx, dict, PDF_NAME_SMaskInData));
+
+			/* fz_new_image drops the buffer itself on failure */
+			jpxbc = bc;
+			bc = NULL;
+			img = fz_new_image(ctx, w, h, 8, fz_keep_colorspace(ctx, jpxcs), xres, yres, 0, 0, (obj && !indexed) ? decode : NULL, NULL, jpxbc, fz_keep_image(ctx, mask));
+			break; /* Out of fz_try */
+		}
+		// EraPDF: keep JPX compressed and decode it at the drawn size <<<
+
+		pix = fz_load_jpx(ctx, buf->data, buf->len, colorspace, indexed, 0);
 
 		obj = pdf_dict_geta(ctx, dict, PDF_NAME_SMask, PDF_NAME_Mask);
 		if (pdf_is_dict(ctx, obj))
@@ -258,16 +295,18 @@ pdf_load_jpx(fz_context *ctx, pdf_document *doc, pdf_obj *dict, int forcemask)
 			fz_decode_tile(ctx, pix, decode);
 		}
 
-		img = fz_new_image_from_pixmap(ctx, pix, mask);
+		img = fz_new_image_from_pixmap(ctx, pix, fz_keep_image(ctx, mask));
 	}
 	fz_always(ctx)
 	{
 		fz_drop_colorspace(ctx, colorspace);
 		fz_drop_buffer(ctx, buf);
 		fz_drop_pixmap(ctx, pix);
+		fz_drop_image(ctx, mask);
 	}
 	fz_catch(ctx)
 	{
+		fz_drop_compressed_buffer(ctx, bc);
 		fz_rethrow(ctx);
 	}
 
@@ -294,11 +333,7 @@ pdf_load_image(fz_context *ctx, pdf_document *doc, pdf_obj *dict)
 
 	image = pdf_load_image_imp(ctx, doc, NULL, dict, NULL, 0);
 
-    if (ctx->preview_heavy_image == 0)
-    {
-        pdf_store_item(ctx, dict, image, fz_image_size(ctx, image));
-    }
-	ctx->preview_heavy_image = 0;
+	pdf_store_item_category(ctx, dict, image, fz_image_size(ctx, image), FZ_STORE_IMAGE);
 
 	return (fz_image *)image;
 }
@@ -127,6 +127,10 @@ pdf_is_hidden_ocg(fz_context *ctx, pdf_ocg_descriptor *desc, pdf_obj *rdb, const
 	if (!ocg)
 		return 0;
 
+	// EraPDF: in place layer switching >>>
+	desc->lookups++;
+	// EraPDF: in place layer switching <<<
+
 	fz_strlcpy(event_state, event, sizeof event_state);
 	fz_strlcat(event_state, "State", sizeof event_state);
 
@@ -52,16 +52,64 @@ static fz_store_type pdf_obj_store_type =
 	pdf_keep_key,
 	pdf_drop_key,
 	pdf_cmp_key,
+	FZ_STORE_RESOURCE,
 #ifndef NDEBUG
 	pdf_debug_key
 #endif
 };
 
+// EraPDF: store categories >>>
+/* Items are found by key and drop function, so all the types are
+ * interchangeable for lookups, they only tell the category apart. */
+static fz_store_type pdf_image_store_type =
+{
+	pdf_make_hash_key,
+	pdf_keep_key,
+	pdf_drop_key,
+	pdf_cmp_key,
+	FZ_STORE_IMAGE,
+#ifndef NDEBUG
+	pdf_debug_key
+#endif
+};
+
+static fz_store_type pdf_font_store_type =
+{
+	pdf_make_hash_key,
+	pdf_keep_key,
+	pdf_drop_key,
+	pdf_cmp_key,
+	FZ_STORE_FONT,
+#ifndef NDEBUG
+	pdf_debug_key
+#endif
+};
+// EraPDF: store categories <<<
+
 void
 pdf_store_item(fz_context *ctx, pdf_obj *key, void *val, unsigned int itemsize)
+{
+	pdf_store_item_category(ctx, key, val, itemsize, FZ_STORE_RESOURCE);
+}
+
+void
+pdf_store_item_category(fz_context *ctx, pdf_obj *key, void *val, unsigned int itemsize, int category)
 {
 	void *existing;
-	existing = fz_store_item(ctx, key, val, itemsize, &pdf_obj_store_type);
+	fz_store_type *type;
+	switch (category)
+	{
+	case FZ_STORE_IMAGE:
+		type = &pdf_image_store_type;
+		break;
+	case FZ_STORE_FONT:
+		type = &pdf_font_store_type;
+		break;
+	default:
+		type = &pdf_obj_store_type;
+		break;
+	}
+	existing = fz_store_item(ctx, key, val, itemsize, type);
 	assert(existing == NULL);
 }
 
@@ -1454,6 +1454,9 @@ pdf_init_document(fz_context *ctx, pdf_document *doc)
 		{
 			/* pdf_repair_xref may access xref_index, so reset it properly */
 			memset(doc->xref_index, 0, sizeof(int) * doc->max_xref_len);
+// EraPDF: repair scans the whole file front to back >>>
+			fz_stream_meta(ctx, doc->file, FZ_STREAM_META_ACCESS, FZ_STREAM_ACCESS_SEQUENTIAL, NULL);
+// EraPDF: repair scans the whole file front to back <<<
 			pdf_repair_xref(ctx, doc);
 			pdf_prime_xref_index(ctx, doc);
 		}
@@ -1534,6 +1537,11 @@ pdf_init_document(fz_context *ctx, pdf_document *doc)
 		fz_rethrow_message(ctx, "cannot open document");
 	}
 
+// EraPDF: pages are read at random, rely on kernel read-around >>>
+	if (repaired)
+		fz_stream_meta(ctx, doc->file, FZ_STREAM_META_ACCESS, FZ_STREAM_ACCESS_NORMAL, NULL);
+// EraPDF: pages are read at random, rely on kernel read-around <<<
+
 	fz_try(ctx)
 	{
 		pdf_read_ocg(ctx, doc);
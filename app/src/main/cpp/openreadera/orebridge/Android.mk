@@ -15,6 +15,8 @@ LOCAL_SRC_FILES := \
 	StStringNaturalCompare.cpp \
 	StSearchUtils.cpp \
 	StSocket.cpp \
+	StSharedBuffer.cpp \
+	StTileCache.cpp \
 	openreadera.cpp \
 	debug_intentional_crash.cpp
 
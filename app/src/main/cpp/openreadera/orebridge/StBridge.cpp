@@ -20,11 +20,14 @@
 #include <cerrno>
 #include <unistd.h>
 #include <fcntl.h>
+#include <vector>
+#include <algorithm>
 
 #include "ore_log.h"
 #include "StProtocol.h"
 #include "StQueue.h"
 #include "StBridge.h"
+#include "StSocket.h"
 
 constexpr static bool LOG = false;
 
@@ -51,6 +54,450 @@ void StBridge::renice() {
     LI("StBridge: Process nice level should not be changed");
 }
 
+void StBridge::processRenderBuffer(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_RENDER_BUFFER;
+    uint8_t* socket_name = nullptr;
+    uint32_t size = 0;
+    CmdDataIterator iter(request.first);
+    iter.getByteArray(&socket_name).getInt(&size);
+    if (!iter.isValid()) {
+        LE("StBridge: Bad request data");
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    if (size == 0) {
+        LI("StBridge: Render buffer detached");
+        renderBuffer.detach();
+        return;
+    }
+    if (pipelineInput != nullptr) {
+        // Single buffer would be overwritten by queued renders before client reads it
+        LE("StBridge: Render buffer is not supported in pipelined mode");
+        response.result = RES_ILLEGAL_STATE;
+        return;
+    }
+    StSocketConnection connection((const char*) socket_name);
+    if (!connection.isValid()) {
+        response.result = RES_BAD_REQ_DATA;
+        return;
+    }
+    int fd = -1;
+    if (!connection.receiveFileDescriptor(fd)) {
+        LE("StBridge: Render buffer fd not received");
+        response.result = RES_INTERNAL_ERROR;
+        return;
+    }
+    int err = renderBuffer.attach(fd, size);
+    if (err != 0) {
+        LE("StBridge: Render buffer not attached: %d %u %d", fd, size, err);
+        response.result = err == EINVAL ? RES_BAD_REQ_DATA : RES_INTERNAL_ERROR;
+        return;
+    }
+    LI("StBridge: Render buffer attached: %u", size);
+}
+
+void StBridge::processTileCache(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_TILE_CACHE;
+    if (request.dataCount > 0) {
+        uint32_t capacity = 0;
+        if (!CmdDataIterator(request.first).getInt(&capacity).isValid()) {
+            LE("StBridge: Bad request data");
+            response.result = RES_BAD_REQ_DATA;
+            return;
+        }
+        if (capacity == 0) {
+            tileCache.clear();
+        } else {
+            tileCache.setCapacity(capacity);
+        }
+    }
+    response.addInt(tileCache.getHits());
+    response.addInt(tileCache.getMisses());
+    response.addInt(tileCache.getCount());
+    response.addInt((uint32_t) tileCache.getBytes());
+    response.addInt((uint32_t) tileCache.getCapacity());
+}
+
+void StBridge::processPrefetch(CmdRequest& request, CmdResponse& response)
+{
+    response.cmd = CMD_RES_PREFETCH;
+    if (request.dataCount > 0) {
+        uint32_t before = 0;
+        uint32_t after = 0;
+        if (!CmdDataIterator(request.first).getInt(&before).getInt(&after).isValid()) {
+            LE("StBridge: Bad request data");
+            response.result = RES_BAD_REQ_DATA;
+            return;
+        }
+        prefetchBefore = std::min(before, (uint32_t) PREFETCH_MAX_PAGES);
+        prefetchAfter = std::min(after, (uint32_t) PREFETCH_MAX_PAGES);
+        if (prefetchBefore == 0 && prefetchAfter == 0) {
+            prefetchQueue.clear();
+            evictPrefetched(1, 0);
+        }
+    }
+    response.addInt((uint32_t) prefetched.size());
+    response.addInt(prefetchHits);
+    response.addInt(prefetchEvicted);
+}
+
+void StBridge::schedulePrefetch(uint32_t page, uint32_t pageCount)
+{
+    if (page >= pageCount) {
+        return;
+    }
+    if (prefetched.erase(page) > 0) {
+        // Page belongs to the client now and is released by its page free request
+        prefetchHits++;
+    }
+    uint32_t first = page - std::min(page, prefetchBefore);
+    uint32_t last = std::min(page + prefetchAfter, pageCount - 1);
+    evictPrefetched(first, last);
+
+    // Pages in reading direction go first
+    bool backward = page < prefetchLast;
+    prefetchLast = page;
+    prefetchQueue.clear();
+    for (uint32_t i = 1; i <= std::max(prefetchBefore, prefetchAfter); i++) {
+        bool next = page + i <= last;
+        bool prev = i <= page - first;
+        if (backward && prev) {
+            prefetchQueue.push_back(page - i);
+        }
+        if (next) {
+            prefetchQueue.push_back(page + i);
+        }
+        if (!backward && prev) {
+            prefetchQueue.push_back(page - i);
+        }
+    }
+    if (!prefetchQueue.empty()) {
+        requestIdle();
+    }
+}
+
+void StBridge::resetPrefetch()
+{
+    prefetchQueue.clear();
+    prefetched.clear();
+}
+
+bool StBridge::prefetchNext()
+{
+    if (prefetchQueue.empty()) {
+        return false;
+    }
+    uint32_t page = prefetchQueue.front();
+    prefetchQueue.pop_front();
+    if (prefetched.count(page) > 0) {
+        return true;
+    }
+    // Reader aborts prefetch as soon as a request is queued, see pipelineReader()
+    pthread_mutex_lock(&pipelineLock);
+    prefetchActive = true;
+    activeCancelled = !pipelineRequests.empty();
+    pthread_mutex_unlock(&pipelineLock);
+    bool loaded = prefetchPage(page);
+    pthread_mutex_lock(&pipelineLock);
+    prefetchActive = false;
+    cancelSignals.clear();
+    bool aborted = activeCancelled;
+    activeCancelled = false;
+    pthread_mutex_unlock(&pipelineLock);
+    if (loaded) {
+        prefetched.insert(page);
+    } else if (aborted) {
+        // Engine dropped what it had built, page is tried again when idle
+        prefetchQueue.push_front(page);
+    }
+    return true;
+}
+
+void StBridge::evictPrefetched(uint32_t first, uint32_t last)
+{
+    for (auto it = prefetched.begin(); it != prefetched.end();) {
+        if (*it >= first && *it <= last) {
+            ++it;
+            continue;
+        }
+        releasePrefetchedPage(*it);
+        prefetchEvicted++;
+        it = prefetched.erase(it);
+    }
+}
+
+uint8_t* StBridge::newRenderPixels(CmdData* holder, uint32_t size)
+{
+    uint8_t* pixels = renderBuffer.get(size);
+    if (pixels != nullptr) {
+        holder->setInt(size);
+        return pixels;
+    }
+    return holder->newByteArray(size);
+}
+
+int StBridge::requestWeight(uint8_t cmd)
+{
+    switch (cmd)
+    {
+    case CMD_REQ_PAGE_INFO:
+    case CMD_REQ_LINKS:
+    case CMD_REQ_OUTLINE:
+    case CMD_REQ_VERSION:
+        return REQ_WEIGHT_LIGHT;
+    case CMD_REQ_SEARCH_COUNTER:
+        // Reads and resets the counter of the search queued before it, so keeps its place
+        return REQ_WEIGHT_NORMAL;
+    case CMD_REQ_PAGE:
+    case CMD_REQ_PAGE_RENDER:
+    case CMD_REQ_PAGE_TILE:
+    case CMD_REQ_SMART_CROP:
+    case CMD_REQ_SEARCH_PREVIEWS:
+    case CMD_REQ_SEARCH_STREAM:
+    case CMD_REQ_SEARCH_HITBOXES:
+    case CMD_REQ_TEXT_INDEX:
+        return REQ_WEIGHT_HEAVY;
+    default:
+        return REQ_WEIGHT_NORMAL;
+    }
+}
+
+void* StBridge::pipelineReader(void* bridge)
+{
+    auto self = static_cast<StBridge*>(bridge);
+    while (true) {
+        auto request = new CmdRequest();
+        int res = self->pipelineInput->readRequest(*request);
+        if (res != 0 && request->cmd == CMD_REQ_CANCEL) {
+            // Processed right away, not queued behind requests it should cancel
+            self->processCancel(*request);
+            delete request;
+            continue;
+        }
+        pthread_mutex_lock(&self->pipelineLock);
+        if (res == 0) {
+            delete request;
+            self->pipelineEof = true;
+        } else {
+            self->pipelineRequests.push_back(request);
+            if (self->prefetchActive) {
+                self->cancelActive();
+            }
+        }
+        pthread_cond_signal(&self->pipelineCond);
+        pthread_mutex_unlock(&self->pipelineLock);
+        if (res == 0) {
+            return nullptr;
+        }
+    }
+}
+
+bool StBridge::isCancelMatch(CmdRequest* request, uint32_t id, uint32_t mode)
+{
+    if (requestWeight(request->cmd) != REQ_WEIGHT_HEAVY) {
+        return false;
+    }
+    if (mode == CANCEL_MODE_OLDER) {
+        return request->id < id;
+    }
+    return request->id == id;
+}
+
+void StBridge::processCancel(CmdRequest& request)
+{
+    CmdResponse response(CMD_RES_CANCEL);
+    response.id = request.id;
+    uint32_t id = 0;
+    uint32_t mode = 0;
+    CmdDataIterator iter(request.first);
+    if (!iter.getInt(&id).getInt(&mode).isValid()) {
+        LE("StBridge: Bad cancel request data");
+        response.result = RES_BAD_REQ_DATA;
+        writeResponse(response);
+        return;
+    }
+    std::vector<CmdRequest*> cancelled;
+    pthread_mutex_lock(&pipelineLock);
+    for (auto it = pipelineRequests.begin(); it != pipelineRequests.end();) {
+        if (isCancelMatch(*it, id, mode)) {
+            cancelled.push_back(*it);
+            it = pipelineRequests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    uint32_t count = cancelled.size();
+    if (activeRequest != nullptr && isCancelMatch(activeRequest, id, mode)) {
+        cancelActive();
+        count++;
+    }
+    pthread_mutex_unlock(&pipelineLock);
+
+    LDD(LOG, "StBridge: Cancelled %u requests by %u %u", count, id, mode);
+    for (CmdRequest* r : cancelled) {
+        CmdResponse skipped(r->cmd + 1);
+        skipped.id = r->id;
+        skipped.result = RES_CANCELLED;
+        writeResponse(skipped);
+        delete r;
+    }
+    response.addInt(count);
+    writeResponse(response);
+}
+
+void StBridge::cancelActive()
+{
+    activeCancelled = true;
+    for (int* signal : cancelSignals) {
+        *signal = 1;
+    }
+}
+
+void StBridge::writeResponse(CmdResponse& response)
+{
+    pthread_mutex_lock(&outputLock);
+    output->writeResponse(response);
+    pthread_mutex_unlock(&outputLock);
+}
+
+void StBridge::sendPartialResponse(CmdRequest& request, CmdResponse& response)
+{
+    response.id = request.id;
+    writeResponse(response);
+}
+
+void StBridge::sendSearchBatch(CmdRequest& request, CmdResponse& response,
+        uint32_t scanned, uint32_t total, uint32_t counter)
+{
+    CmdResponse batch(response.cmd);
+    batch.addInt(scanned).addInt(total).addInt((uint32_t) 0).addInt(counter);
+    batch.moveData(response);
+    sendPartialResponse(request, batch);
+}
+
+void StBridge::finishSearchStream(CmdResponse& response, uint32_t scanned, uint32_t total, uint32_t counter)
+{
+    CmdDataList results;
+    results.moveData(response);
+    response.addInt(scanned).addInt(total).addInt((uint32_t) 1).addInt(counter);
+    response.moveData(results);
+}
+
+bool StBridge::isCancelled()
+{
+    return activeCancelled;
+}
+
+void StBridge::setCancelSignal(int* signal)
+{
+    pthread_mutex_lock(&pipelineLock);
+    cancelSignals.clear();
+    pthread_mutex_unlock(&pipelineLock);
+    addCancelSignal(signal);
+}
+
+void StBridge::addCancelSignal(int* signal)
+{
+    if (signal == nullptr) {
+        return;
+    }
+    pthread_mutex_lock(&pipelineLock);
+    cancelSignals.push_back(signal);
+    if (activeCancelled) {
+        *signal = 1;
+    }
+    pthread_mutex_unlock(&pipelineLock);
+}
+
+CmdRequest* StBridge::nextPipelinedRequest()
+{
+    pthread_mutex_lock(&pipelineLock);
+    while (pipelineRequests.empty() && !pipelineEof) {
+        if (idleWork) {
+            // Idle work runs on the processing thread, so engine needs no locking
+            pthread_mutex_unlock(&pipelineLock);
+            // Prefetch goes first, next page is more likely wanted soon than background indexing
+            idleWork = prefetchNext() || processIdle();
+            pthread_mutex_lock(&pipelineLock);
+            continue;
+        }
+        pthread_cond_wait(&pipelineCond, &pipelineLock);
+    }
+    CmdRequest* request = nullptr;
+    if (!pipelineRequests.empty()) {
+        // Light request can overtake heavy requests queued before it,
+        // but never a request that may change engine state
+        auto next = pipelineRequests.begin();
+        for (auto it = pipelineRequests.begin(); it != pipelineRequests.end(); ++it) {
+            int weight = requestWeight((*it)->cmd);
+            if (weight == REQ_WEIGHT_LIGHT) {
+                next = it;
+                break;
+            }
+            if (weight != REQ_WEIGHT_HEAVY) {
+                break;
+            }
+        }
+        request = *next;
+        pipelineRequests.erase(next);
+    }
+    activeRequest = request;
+    activeCancelled = false;
+    pthread_mutex_unlock(&pipelineLock);
+    return request;
+}
+
+int StBridge::mainPipelined(RequestQueue& in)
+{
+    in.setTagged(true);
+    output->setTagged(true);
+    pipelineInput = &in;
+
+    pthread_t reader;
+    if (pthread_create(&reader, nullptr, pipelineReader, this) != 0) {
+        LE("StBridge: Request reader not started: %d", errno);
+        return -1;
+    }
+    pthread_detach(reader);
+
+    CmdResponse response;
+    bool run = true;
+    while (run) {
+        LDD(LOG, "StBridge: Waiting for pipelined request...");
+        CmdRequest* request = nextPipelinedRequest();
+        if (request == nullptr) {
+            LE("StBridge: No data received");
+            return -1;
+        }
+        LDD(LOG, "StBridge: Processing request %u...", request->id);
+        if (request->cmd == CMD_REQ_PIPELINE) {
+            response.cmd = CMD_RES_PIPELINE;
+        } else {
+            process(*request, response);
+        }
+        pthread_mutex_lock(&pipelineLock);
+        activeRequest = nullptr;
+        cancelSignals.clear();
+        pthread_mutex_unlock(&pipelineLock);
+        if (activeCancelled) {
+            uint8_t cmd = response.cmd;
+            response.reset();
+            response.cmd = cmd;
+            response.result = RES_CANCELLED;
+        }
+        response.id = request->id;
+        LDD(LOG, "StBridge: Sending response %u...", response.id);
+        writeResponse(response);
+        run = response.cmd != CMD_RES_QUIT;
+        delete request;
+        response.reset();
+    }
+    LI("StBridge: Exit");
+    return 0;
+}
+
 int StBridge::main(int argc, char *argv[]) {
     if (argc < 3) {
         LE("StBridge: No command line arguments");
@@ -60,6 +507,7 @@ int StBridge::main(int argc, char *argv[]) {
 
     LD("StBridge: Output file: %s", argv[2]);
     ResponseQueue out(argv[2], O_WRONLY, lctx);
+    output = &out;
 
     LI("StBridge: Sending ready notification...");
     out.sendReadyNotification();
@@ -77,6 +525,25 @@ int StBridge::main(int argc, char *argv[]) {
             LE("StBridge: No data received");
             return -1;
         }
+        if (request.cmd == CMD_REQ_PIPELINE) {
+            LI("StBridge: Switching to pipelined mode");
+            // Pipelined responses carry pixels inline, see processRenderBuffer()
+            renderBuffer.detach();
+            response.cmd = CMD_RES_PIPELINE;
+            out.writeResponse(response);
+            request.reset();
+            response.reset();
+            return mainPipelined(in);
+        }
+        if (request.cmd == CMD_REQ_CANCEL) {
+            // Nothing can be queued or in-flight in sequential mode
+            response.cmd = CMD_RES_CANCEL;
+            response.addInt((uint32_t) 0);
+            out.writeResponse(response);
+            request.reset();
+            response.reset();
+            continue;
+        }
         LDD(LOG, "StBridge: Processing request...");
         process(request, response);
         LDD(LOG, "StBridge: Sending response...");
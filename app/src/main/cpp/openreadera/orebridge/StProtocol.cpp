@@ -194,6 +194,26 @@ CmdDataList& CmdDataList::addData(CmdData* data)
     return *this;
 }
 
+CmdDataList& CmdDataList::moveData(CmdDataList& other)
+{
+    if (other.first != nullptr)
+    {
+        if (last == nullptr)
+        {
+            first = other.first;
+        }
+        else
+        {
+            last->nextData = other.first;
+        }
+        last = other.last;
+        dataCount += other.dataCount;
+        other.first = other.last = nullptr;
+        other.dataCount = 0;
+    }
+    return *this;
+}
+
 CmdDataList& CmdDataList::addInt(uint32_t val)
 {
     return addData((new CmdData())->setInt(val));
@@ -231,10 +251,12 @@ CmdDataList& CmdDataList::addIpcString(const char* data, bool owned)
 CmdRequest::CmdRequest()
 {
     cmd = CMD_UNKNOWN;
+    id = 0;
 }
 CmdRequest::CmdRequest(uint8_t c)
 {
     cmd = c;
+    id = 0;
 }
 CmdRequest::~CmdRequest()
 {
@@ -248,13 +270,14 @@ void CmdRequest::reset()
         delete first;
     }
     cmd = CMD_UNKNOWN;
+    id = 0;
     dataCount = 0;
     first = last = nullptr;
 }
 
 void CmdRequest::print(const char* lctx)
 {
-    LDD(LOG, "CmdData: Request: %s %u", lctx, this->cmd);
+    LDD(LOG, "CmdData: Request: %s %u %u", lctx, this->cmd, this->id);
     CmdData* data;
     for (data = this->first; data != nullptr; data = data->nextData)
     {
@@ -266,12 +289,14 @@ CmdResponse::CmdResponse()
 {
     cmd = CMD_UNKNOWN;
     result = RES_OK;
+    id = 0;
 }
 
 CmdResponse::CmdResponse(uint8_t c)
 {
     cmd = c;
     result = RES_OK;
+    id = 0;
 }
 
 CmdResponse::~CmdResponse()
@@ -287,12 +312,13 @@ void CmdResponse::reset()
     }
     cmd = CMD_UNKNOWN;
     result = RES_OK;
+    id = 0;
     first = last = nullptr;
 }
 
 void CmdResponse::print(const char* lctx)
 {
-    LDD(LOG, "CmdData: Response: %s %u %u", lctx, this->cmd, this->result);
+    LDD(LOG, "CmdData: Response: %s %u %u %u", lctx, this->cmd, this->result, this->id);
     CmdData* data;
     for (data = this->first; data != nullptr; data = data->nextData)
     {
@@ -38,6 +38,7 @@ constexpr static bool LOG = false;
 Queue::Queue(const char* fname, int mode, const char* lctx)
 {
     fp = open(fname, mode);
+    tagged = false;
     pthread_mutex_init(&readlock, nullptr);
     pthread_mutex_init(&writelock, nullptr);
 }
@@ -50,6 +51,11 @@ Queue::~Queue()
     pthread_mutex_destroy(&writelock);
 }
 
+void Queue::setTagged(bool value)
+{
+    tagged = value;
+}
+
 int Queue::readBuffer(int size, uint8_t* buf)
 {
     int count = 0;
@@ -42,6 +42,12 @@ void RequestQueue::writeRequest(CmdRequest& request)
     LDD(LOG, "RequestQueue: Writing request cmd: %02x", cmd);
     write(fp, &(cmd), sizeof(cmd));
 
+    if (tagged)
+    {
+        LDD(LOG, "RequestQueue: Writing request id: %u", request.id);
+        write(fp, &(request.id), sizeof(request.id));
+    }
+
     CmdData* data = request.first;
     while (data != nullptr)
     {
@@ -49,9 +55,6 @@ void RequestQueue::writeRequest(CmdRequest& request)
         data = data->nextData;
     }
 
-    LDD(LOG, "RequestQueue: Flush request");
-    fdatasync(fp);
-
     pthread_mutex_unlock(&writelock);
 }
 
@@ -74,6 +77,18 @@ int RequestQueue::readRequest(CmdRequest& request)
     uint8_t hasData = cmd & CMD_MASK_HAS_DATA;
     LDD(LOG, "RequestQueue: Request cmd: %d, has data: %d", request.cmd, hasData);
 
+    if (tagged)
+    {
+        res = readInt(&(request.id));
+        if (res == 0)
+        {
+            LDD(LOG, "RequestQueue: No request id received");
+            pthread_mutex_unlock(&readlock);
+            return 0;
+        }
+        LDD(LOG, "RequestQueue: Request id: %u", request.id);
+    }
+
     CmdData* data = request.first;
     while (hasData)
     {
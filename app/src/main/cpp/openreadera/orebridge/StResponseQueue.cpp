@@ -56,6 +56,12 @@ void ResponseQueue::writeResponse(CmdResponse& response)
     LDD(LOG, "ResponseQueue: Writing response result: %d", response.result);
     write(fp, &(response.result), sizeof(response.result));
 
+    if (tagged)
+    {
+        LDD(LOG, "ResponseQueue: Writing response id: %u", response.id);
+        write(fp, &(response.id), sizeof(response.id));
+    }
+
     CmdData* data = response.first;
     while (data != nullptr)
     {
@@ -63,9 +69,6 @@ void ResponseQueue::writeResponse(CmdResponse& response)
         data = data->nextData;
     }
 
-    LDD(LOG, "ResponseQueue: Flush response");
-    fdatasync(fp);
-
     pthread_mutex_unlock(&writelock);
 }
 
@@ -98,6 +101,17 @@ int ResponseQueue::readResponse(CmdResponse& response)
     }
     LDD(LOG, "ResponseQueue: Response result: %d", response.result);
 
+    if (tagged)
+    {
+        res = readInt(&(response.id));
+        if (res == 0)
+        {
+            pthread_mutex_unlock(&readlock);
+            return 0;
+        }
+        LDD(LOG, "ResponseQueue: Response id: %u", response.id);
+    }
+
     CmdData* data = response.first;
     while (hasData)
     {
@@ -149,8 +163,15 @@ int ResponseQueue::readResponseHeader(CmdResponse& response, uint8_t& has_next)
     res = readByte(&(response.result));
     if (res == 0) {
         has_next = 0;
+        return res;
     }
     LDD(LOG, "ResponseQueue: Response result: %d", response.result);
+    if (tagged) {
+        res = readInt(&(response.id));
+        if (res == 0) {
+            has_next = 0;
+        }
+    }
     return res;
 }
 
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ore_log.h"
+#include "StSharedBuffer.h"
+
+constexpr static bool LOG = false;
+
+StSharedBuffer::StSharedBuffer()
+    : fd(-1), data(nullptr), size(0)
+{
+}
+
+StSharedBuffer::~StSharedBuffer()
+{
+    detach();
+}
+
+int StSharedBuffer::attach(int fd, size_t size)
+{
+    detach();
+    if (fd < 0) {
+        return EINVAL;
+    }
+    // Writing past the end of a smaller memfd would raise SIGBUS instead of failing here
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        LE("StSharedBuffer: fstat() failed: %d %d", fd, err);
+        close(fd);
+        return err;
+    }
+    if (size == 0 || st.st_size < 0 || (uint64_t) st.st_size < size) {
+        LE("StSharedBuffer: buffer is smaller than requested: %d %lld %zu",
+                fd, (long long) st.st_size, size);
+        close(fd);
+        return EINVAL;
+    }
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        int err = errno;
+        LE("StSharedBuffer: mmap() failed: %d %zu %d", fd, size, err);
+        close(fd);
+        return err;
+    }
+    this->fd = fd;
+    this->data = static_cast<uint8_t*>(ptr);
+    this->size = size;
+    LDD(LOG, "StSharedBuffer: attached: %d %p %zu", fd, ptr, size);
+    return 0;
+}
+
+void StSharedBuffer::detach()
+{
+    if (data != nullptr) {
+        LDD(LOG, "StSharedBuffer: detached: %d %p %zu", fd, data, size);
+        munmap(data, size);
+        data = nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    size = 0;
+}
+
+uint8_t* StSharedBuffer::get(size_t required)
+{
+    if (data == nullptr || required > size) {
+        return nullptr;
+    }
+    return data;
+}
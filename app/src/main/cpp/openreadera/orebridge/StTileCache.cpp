@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#include <cstdlib>
+
+#include "ore_log.h"
+#include "StTileCache.h"
+
+constexpr static bool LOG = false;
+
+StTileCache::StTileCache()
+    : capacity(TILE_CACHE_DEFAULT_SIZE), bytes(0), hits(0), misses(0)
+{
+}
+
+StTileCache::~StTileCache()
+{
+    clear();
+}
+
+const uint8_t* StTileCache::get(const StTileKey& key)
+{
+    auto found = index.find(key);
+    if (found == index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    tiles.splice(tiles.begin(), tiles, found->second);
+    return found->second->pixels;
+}
+
+uint8_t* StTileCache::put(const StTileKey& key, uint32_t size)
+{
+    remove(key);
+    if (size > capacity) {
+        return nullptr;
+    }
+    evict(size);
+    auto pixels = static_cast<uint8_t*>(malloc(size));
+    if (pixels == nullptr) {
+        LE("StTileCache: Tile not allocated: %u", size);
+        return nullptr;
+    }
+    tiles.push_front(Tile{ key, pixels, size });
+    index[key] = tiles.begin();
+    bytes += size;
+    LDD(LOG, "StTileCache: Tile added: %u %u:%u %zu", key.page, key.x, key.y, bytes);
+    return pixels;
+}
+
+void StTileCache::remove(const StTileKey& key)
+{
+    auto found = index.find(key);
+    if (found != index.end()) {
+        erase(found->second);
+    }
+}
+
+void StTileCache::removePage(uint32_t page)
+{
+    for (auto it = tiles.begin(); it != tiles.end();) {
+        auto next = std::next(it);
+        if (it->key.page == page) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void StTileCache::clear()
+{
+    for (Tile& tile : tiles) {
+        free(tile.pixels);
+    }
+    tiles.clear();
+    index.clear();
+    bytes = 0;
+}
+
+void StTileCache::setCapacity(size_t capacity)
+{
+    this->capacity = capacity;
+    evict(0);
+}
+
+void StTileCache::evict(size_t required)
+{
+    while (!tiles.empty() && bytes + required > capacity) {
+        erase(std::prev(tiles.end()));
+    }
+}
+
+void StTileCache::erase(std::list<Tile>::iterator it)
+{
+    bytes -= it->bytes;
+    free(it->pixels);
+    index.erase(it->key);
+    tiles.erase(it);
+}
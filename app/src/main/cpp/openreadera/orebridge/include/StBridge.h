@@ -18,20 +18,116 @@
 #ifndef __ST_BRIDGE_H__
 #define __ST_BRIDGE_H__
 
+#include <atomic>
+#include <deque>
+#include <set>
+#include <vector>
+#include <pthread.h>
+
 #include "StProtocol.h"
+#include "StSharedBuffer.h"
+#include "StTileCache.h"
+
+/// Light requests may overtake queued heavy ones in pipelined mode
+#define REQ_WEIGHT_LIGHT    0
+#define REQ_WEIGHT_NORMAL   1
+#define REQ_WEIGHT_HEAVY    2
+
+#define PREFETCH_DEFAULT_BEFORE 1
+#define PREFETCH_DEFAULT_AFTER  2
+#define PREFETCH_MAX_PAGES      8
+
+class RequestQueue;
+class ResponseQueue;
 
 class StBridge
 {
 public:
     StBridge(const char* lctx) {
         this->lctx = lctx;
+        activeCancelled = false;
+        pthread_mutex_init(&pipelineLock, nullptr);
+        pthread_mutex_init(&outputLock, nullptr);
+        pthread_cond_init(&pipelineCond, nullptr);
+    };
+    virtual ~StBridge() {
+        pthread_cond_destroy(&pipelineCond);
+        pthread_mutex_destroy(&outputLock);
+        pthread_mutex_destroy(&pipelineLock);
     };
-    virtual ~StBridge() {};
     virtual int main(int argc, char *argv[]);
     virtual void process(CmdRequest& request, CmdResponse& response)=0;
 protected:
     const char* lctx;
+    StSharedBuffer renderBuffer;
+    StTileCache tileCache;
     void renice();
+    void processRenderBuffer(CmdRequest& request, CmdResponse& response);
+    void processTileCache(CmdRequest& request, CmdResponse& response);
+    void processPrefetch(CmdRequest& request, CmdResponse& response);
+    uint8_t* newRenderPixels(CmdData* holder, uint32_t size);
+    virtual int requestWeight(uint8_t cmd);
+    /// Engines should check it periodically during long operations and stop early
+    bool isCancelled();
+    /// Registers engine abort flag (e.g. fz_cookie::abort) set on cancel, nullptr to unregister all
+    void setCancelSignal(int* signal);
+    /// Registers one more abort flag, e.g. cookie of another render thread
+    void addCancelSignal(int* signal);
+    /// Schedules processIdle() calls while no requests are queued (pipelined mode only)
+    void requestIdle() { idleWork = true; }
+    /// Performs small step of background work, returns false when no work is left
+    virtual bool processIdle() { return false; }
+    /// Called by engines for every rendered page, schedules background loading of its neighbours
+    void schedulePrefetch(uint32_t page, uint32_t pageCount);
+    /// Forgets prefetched pages, engine calls it when it releases all pages by itself
+    void resetPrefetch();
+    /// Loads page in background, returns true if page was loaded by this call and should be released on eviction.
+    /// Runs under cancel signals: once cancelled, engine drops what it has built and returns false
+    virtual bool prefetchPage(uint32_t page) { return false; }
+    /// Releases prefetched page that was not requested while it was in prefetch window
+    virtual void releasePrefetchedPage(uint32_t page) {}
+    /// Writes additional response to request being processed, final response is written after process()
+    void sendPartialResponse(CmdRequest& request, CmdResponse& response);
+    /// Streaming search: sends results collected in response so far as a partial response
+    void sendSearchBatch(CmdRequest& request, CmdResponse& response,
+            uint32_t scanned, uint32_t total, uint32_t counter);
+    /// Streaming search: puts progress header with done flag before results of final response
+    void finishSearchStream(CmdResponse& response, uint32_t scanned, uint32_t total, uint32_t counter);
+private:
+    RequestQueue* pipelineInput = nullptr;
+    ResponseQueue* output = nullptr;
+    /// Responses are written by processing thread and by pipelined request reader
+    pthread_mutex_t outputLock;
+    bool pipelineEof = false;
+    std::deque<CmdRequest*> pipelineRequests;
+    pthread_mutex_t pipelineLock;
+    pthread_cond_t pipelineCond;
+
+    CmdRequest* activeRequest = nullptr;
+    std::atomic_bool activeCancelled;
+    std::vector<int*> cancelSignals;
+    bool idleWork = false;
+    /// Set while prefetchPage() runs, any queued request cancels it
+    bool prefetchActive = false;
+
+    uint32_t prefetchBefore = PREFETCH_DEFAULT_BEFORE;
+    uint32_t prefetchAfter = PREFETCH_DEFAULT_AFTER;
+    uint32_t prefetchLast = 0;
+    std::deque<uint32_t> prefetchQueue;
+    std::set<uint32_t> prefetched;
+    uint32_t prefetchHits = 0;
+    uint32_t prefetchEvicted = 0;
+
+    static void* pipelineReader(void* bridge);
+    int mainPipelined(RequestQueue& in);
+    void writeResponse(CmdResponse& response);
+    CmdRequest* nextPipelinedRequest();
+    bool prefetchNext();
+    void evictPrefetched(uint32_t first, uint32_t last);
+    void processCancel(CmdRequest& request);
+    /// Sets cancelled flag and all cancel signals, pipelineLock must be held
+    void cancelActive();
+    bool isCancelMatch(CmdRequest* request, uint32_t id, uint32_t mode);
 };
 
 #endif
@@ -35,6 +35,7 @@
 #define CMD_RES_QUIT        5
 #define CMD_REQ_PAGE_INFO   6
 #define CMD_RES_PAGE_INFO   7
+/// Response (EraPDF): heavy image flag, always 0 as JPX images are decoded at drawn size.
 #define CMD_REQ_PAGE        8
 #define CMD_RES_PAGE        9
 #define CMD_REQ_PAGE_RENDER 10
@@ -100,6 +101,69 @@
 #define CMD_RES_PDF_XPATH_BY_COORDS     69
 #define CMD_REQ_FONT_NAMES              70
 #define CMD_RES_FONT_NAMES              71
+/// Attaches client memfd/ashmem buffer (received via socket) as page render target.
+/// When attached, CMD_RES_PAGE_RENDER carries pixels byte count (int) instead of pixels array.
+/// Sequential mode only: buffer is detached by CMD_REQ_PIPELINE and attaching it afterwards
+/// fails with RES_ILLEGAL_STATE, as queued renders would overwrite pixels not yet read.
+#define CMD_REQ_RENDER_BUFFER           72
+#define CMD_RES_RENDER_BUFFER           73
+/// Switches connection to pipelined mode: every following request carries 4-byte id after cmd,
+/// every following response carries id of its request after result. Responses may come out of order.
+#define CMD_REQ_PIPELINE                74
+#define CMD_RES_PIPELINE                75
+/// Pipelined mode only. Cancels queued and in-flight heavy requests (render, search, etc).
+/// Data: request id, cancel mode. Cancelled requests are answered with RES_CANCELLED.
+#define CMD_REQ_CANCEL                  76
+#define CMD_RES_CANCEL                  77
+/// Renders square tile of page scaled by zoom, tiles are kept in engine LRU tile cache.
+/// Data: page index, zoom (float), tile column, tile row, tile size in pixels (1..TILE_MAX_SIZE).
+#define CMD_REQ_PAGE_TILE               78
+#define CMD_RES_PAGE_TILE               79
+/// Data (optional): tile cache capacity in bytes, 0 to clear the cache.
+/// Response: hits, misses, tiles count, tiles bytes, capacity.
+#define CMD_REQ_TILE_CACHE              80
+#define CMD_RES_TILE_CACHE              81
+/// Data: build mode (0 - status only, 1 - build in background, 2 - build now).
+/// Response: indexed pages count, document pages count.
+#define CMD_REQ_TEXT_INDEX              82
+#define CMD_RES_TEXT_INDEX              83
+/// Same data as CMD_REQ_SEARCH_PREVIEWS followed by batch size in pages.
+/// Results are sent in several responses with request id, every response starts with
+/// pages scanned, pages total, done flag and search pack counter. Last response has done flag set.
+#define CMD_REQ_SEARCH_STREAM           84
+#define CMD_RES_SEARCH_STREAM           85
+/// EraDjVu only. Data (optional): decoded files cache size in bytes, 0 to clear the cache.
+/// Response: hits, misses (pages opened by client requests, prefetch is not counted), cached bytes, cache size.
+#define CMD_REQ_DJVU_CACHE              86
+#define CMD_RES_DJVU_CACHE              87
+/// Pipelined mode only. Neighbour pages of rendered page are loaded while no requests are queued,
+/// a queued request interrupts loading.
+/// Data (optional): pages before, pages after rendered page, 0 and 0 to disable prefetch.
+/// Response: prefetched pages held, prefetch hits, evicted pages.
+#define CMD_REQ_PREFETCH                88
+#define CMD_RES_PREFETCH                89
+/// EraEpub only. Progress of pagination started by CMD_REQ_OPEN with CONFIG_CRE_PROGRESSIVE_RENDER.
+/// Data (optional): 1 to finish pagination before response.
+/// Response: done flag, available pages, estimated pages total, rendered percent.
+#define CMD_REQ_CRE_PAGINATION          90
+#define CMD_RES_CRE_PAGINATION          91
+/// EraEpub only. Data (optional): glyph cache size in bytes, 0 to clear the cache.
+/// Response: hits, misses, evicted glyphs, cached glyphs, cached bytes, cache size.
+#define CMD_REQ_CRE_GLYPH_CACHE         92
+#define CMD_RES_CRE_GLYPH_CACHE         93
+/// EraPDF only. Data (optional): budgets in bytes for display lists, decoded images, glyphs and fonts,
+/// 0 leaves the category limited by CMD_REQ_PDF_STORAGE only (default size for glyphs).
+/// Response: used bytes and budget for every category in the same order, then store used bytes and store size.
+#define CMD_REQ_PDF_MEMORY              94
+#define CMD_RES_PDF_MEMORY              95
+/// EraPDF only. Data: memory limit in megabytes, sent by the host on memory pressure.
+/// Display lists of pages farthest from the last viewed page go first, then store and glyph cache.
+/// Response: used bytes after trimming.
+#define CMD_REQ_PDF_TRIM_MEMORY         96
+#define CMD_RES_PDF_TRIM_MEMORY         97
+#define TEXT_INDEX_STATUS               0
+#define TEXT_INDEX_BUILD_BACKGROUND     1
+#define TEXT_INDEX_BUILD_NOW            2
 
 #define CMD_REQ_INSTALL_FONTS 64
 #define CMD_RES_INSTALL_FONTS 65
@@ -120,6 +184,7 @@
 #define RES_ILLEGAL_STATE                       2
 #define RES_BAD_REQ_DATA                        3
 #define RES_INTERNAL_ERROR                      4
+#define RES_CANCELLED                           5
 #define RES_ARCHIVE_COLLISION                   45
 #define RES_MUPDF_PWD_WRONG                     251
 #define RES_MUPDF_PWD_NEED                      252
@@ -144,6 +209,9 @@
 #define LINK_TARGET_LAUNCH              4
 #define LINK_TARGET_UNKNOWN             10
 
+#define CANCEL_MODE_EXACT               0
+#define CANCEL_MODE_OLDER               1
+
 #define RENDER_MATRIX_SIZE 6
 #define TEXT_NULL_PATH "0"
 #define META_STRING_MAX_LENGTH 2000
@@ -234,12 +302,15 @@ public:
     CmdDataList& addIntArray(int n, int* ptr, bool owned);
     CmdDataList& addFloatArray(int n, float* ptr, bool owned);
     CmdDataList& addIpcString(const char* data, bool owned);
+    /// Appends all data of other list, other list becomes empty
+    CmdDataList& moveData(CmdDataList& other);
 };
 
 class CmdRequest: public CmdDataList
 {
 public:
     uint8_t cmd;
+    uint32_t id;
 
 public:
     CmdRequest();
@@ -256,6 +327,7 @@ class CmdResponse: public CmdDataList
 public:
     uint8_t cmd;
     uint8_t result;
+    uint32_t id;
 
 public:
     CmdResponse();
@@ -24,6 +24,8 @@ class Queue
 {
 protected:
     int fp;
+    /// Pipelined mode: messages carry request id, see CMD_REQ_PIPELINE
+    bool tagged;
     pthread_mutex_t readlock;
     pthread_mutex_t writelock;
 
@@ -31,6 +33,7 @@ protected:
     Queue(const char* fname, int mode, const char* lctx);
     ~Queue();
 protected:
+    void setTagged(bool value);
     int readBuffer(int size, uint8_t* buf);
     int readByte(uint8_t* buf);
     int readInt(uint32_t* buf);
@@ -43,6 +46,7 @@ class RequestQueue : Queue
 public:
     RequestQueue(const char* fname, int mode, const char* lctx);
 public:
+    using Queue::setTagged;
     int readRequest(CmdRequest& request);
     void writeRequest(CmdRequest& request);
 };
@@ -52,6 +56,7 @@ class ResponseQueue : Queue
 public:
     ResponseQueue(const char* fname, int mode, const char* lctx);
 public:
+    using Queue::setTagged;
     void sendReadyNotification();
     int readResponse(CmdResponse& response);
     bool readResponseValid(CmdResponse& response, int cmd);
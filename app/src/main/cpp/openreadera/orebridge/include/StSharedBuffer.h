@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#ifndef __ST_SHARED_BUFFER_H__
+#define __ST_SHARED_BUFFER_H__
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Client provided memory region (memfd/ashmem) mapped into the engine process.
+ * Used as render target, so page pixels are not streamed through the FIFO.
+ */
+class StSharedBuffer
+{
+private:
+    int fd;
+    uint8_t* data;
+    size_t size;
+
+public:
+    StSharedBuffer();
+    ~StSharedBuffer();
+
+    StSharedBuffer(StSharedBuffer const&)            = delete;
+    StSharedBuffer& operator=(StSharedBuffer const&) = delete;
+
+public:
+    /// Takes ownership of fd. Previously attached buffer is released.
+    /// Returns 0 on success, errno otherwise: EINVAL if fd is smaller than size.
+    int attach(int fd, size_t size);
+    void detach();
+
+    bool isValid() { return data != nullptr; }
+    size_t getSize() { return size; }
+    /// Returns mapped memory if it can hold requested number of bytes, nullptr otherwise.
+    uint8_t* get(size_t required);
+};
+
+#endif
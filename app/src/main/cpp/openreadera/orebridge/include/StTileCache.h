@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2013-2020 READERA LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Developers: ReadEra Team (2013-2020).
+ */
+
+#ifndef __ST_TILE_CACHE_H__
+#define __ST_TILE_CACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <tuple>
+
+#define TILE_CACHE_DEFAULT_SIZE (32 * 1024 * 1024)
+/// Largest tile side accepted from client, keeps tile pixels byte size far from uint32_t overflow
+#define TILE_MAX_SIZE 4096
+
+class StTileKey
+{
+public:
+    uint32_t page;
+    float zoom;
+    uint32_t x;
+    uint32_t y;
+    uint32_t size;
+    /// Engine render settings generation, tiles rendered with old settings are never hit
+    uint32_t config;
+
+    bool operator<(const StTileKey& other) const
+    {
+        return std::tie(page, zoom, x, y, size, config)
+                < std::tie(other.page, other.zoom, other.x, other.y, other.size, other.config);
+    }
+};
+
+/**
+ * LRU cache of rendered RGBA page tiles, limited by total pixels byte size.
+ */
+class StTileCache
+{
+private:
+    class Tile
+    {
+    public:
+        StTileKey key;
+        uint8_t* pixels;
+        uint32_t bytes;
+    };
+
+    std::list<Tile> tiles;
+    std::map<StTileKey, std::list<Tile>::iterator> index;
+    size_t capacity;
+    size_t bytes;
+    uint32_t hits;
+    uint32_t misses;
+
+    void evict(size_t required);
+    void erase(std::list<Tile>::iterator it);
+
+public:
+    StTileCache();
+    ~StTileCache();
+
+    StTileCache(StTileCache const&)            = delete;
+    StTileCache& operator=(StTileCache const&) = delete;
+
+public:
+    /// Returns cached tile pixels and marks tile as recently used, nullptr on miss
+    const uint8_t* get(const StTileKey& key);
+    /// Allocates pixels for a new tile, least recently used tiles are evicted to fit it.
+    /// Returns nullptr if tile is larger than the whole cache.
+    uint8_t* put(const StTileKey& key, uint32_t size);
+    void remove(const StTileKey& key);
+    void removePage(uint32_t page);
+    void clear();
+
+    void setCapacity(size_t capacity);
+    size_t getCapacity() { return capacity; }
+    size_t getBytes() { return bytes; }
+    uint32_t getCount() { return (uint32_t) index.size(); }
+    uint32_t getHits() { return hits; }
+    uint32_t getMisses() { return misses; }
+};
+
+#endif
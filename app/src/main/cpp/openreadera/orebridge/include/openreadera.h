@@ -103,6 +103,23 @@ void OreVerResporse(const char* base_version, CmdResponse& response);
 #define CONFIG_MUPDF_FONT_PDF_DINGBAT_R 137
 #define CONFIG_MUPDF_INVERT_IMAGES 200
 #define CONFIG_ERA_EMBEDDED_STYLES 201
+/**
+ * Number of threads rasterizing page bands, 0 or 1 for single-threaded rendering
+ */
+#define CONFIG_MUPDF_RENDER_THREADS 202
+/**
+ * Directory for persistent text index files, index is kept in memory only if not set
+ */
+#define CONFIG_MUPDF_TEXT_INDEX_DIR 203
+/**
+ * Directory for EraEpub layout cache files, formatting is not cached if not set
+ */
+#define CONFIG_CRE_LAYOUT_CACHE_DIR 204
+/**
+ * Final blocks laid out before CMD_REQ_OPEN answers, rest of document is paginated on idle
+ * or by CMD_REQ_CRE_PAGINATION, 0 to paginate whole document on open
+ */
+#define CONFIG_CRE_PROGRESSIVE_RENDER 205
 
 #define HARDCONFIG_DJVU_RENDERING_MODE 0
 #define HARDCONFIG_MUPDF_SLOW_CMYK 0